@@ -1,17 +1,13 @@
-QT += core gui charts widgets
-
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
-
-TARGET = insulinpump
-TEMPLATE = app
-
-SOURCES += \
-    main.cpp \
-    $$files(src/*.cpp, true)
-
-HEADERS += \
-    $$files(src/*.h, true)
-
-FORMS += mainwindow.ui
-
-CONFIG  += c++17
+# core -> Qt-free pump library, app -> insulinpump GUI, cli -> pumpsim batch runner,
+# bench -> pumpbench microbenchmarks
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    core \
+    app \
+    cli \
+    bench
+
+app.depends = core
+cli.depends = core
+bench.depends = core
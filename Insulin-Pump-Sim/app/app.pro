@@ -0,0 +1,33 @@
+QT += core gui charts widgets network
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = insulinpump
+TEMPLATE = app
+
+include(../core/core.pri)
+
+SOURCES += \
+    $$PWD/../main.cpp \
+    $$files($$PWD/../src/views/*.cpp) \
+    $$files($$PWD/../src/dialogs/*.cpp) \
+    $$PWD/../src/logic/InsulinDelivery.cpp \
+    $$PWD/../src/logic/basalmanager.cpp \
+    $$PWD/../src/logic/controlserver.cpp \
+    $$PWD/../src/logic/datamanager.cpp \
+    $$PWD/../src/logic/deliverythread.cpp \
+    $$PWD/../src/logic/navigationmanager.cpp
+
+HEADERS += \
+    $$files($$PWD/../src/views/*.h) \
+    $$files($$PWD/../src/dialogs/*.h) \
+    $$PWD/../src/logic/insulindelivery.h \
+    $$PWD/../src/logic/basalmanager.h \
+    $$PWD/../src/logic/controlserver.h \
+    $$PWD/../src/logic/datamanager.h \
+    $$PWD/../src/logic/deliverythread.h \
+    $$PWD/../src/logic/navigationmanager.h
+
+FORMS += $$PWD/../mainwindow.ui
+
+CONFIG  += c++17
@@ -0,0 +1,16 @@
+# pumpbench: microbenchmarks for the pump computations, JSON results
+# Run a release build: ./pumpbench --json results.json
+TEMPLATE = app
+CONFIG += console c++17 release
+CONFIG -= app_bundle
+QT = core
+TARGET = pumpbench
+
+include(../core/core.pri)
+
+SOURCES += \
+    $$PWD/../src/bench/pumpbench.cpp \
+    $$PWD/../src/logic/datamanager.cpp
+
+HEADERS += \
+    $$PWD/../src/logic/datamanager.h
@@ -0,0 +1,10 @@
+# pumpsim: headless batch runs on the pump core, links no Qt
+TEMPLATE = app
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+TARGET = pumpsim
+
+include(../core/core.pri)
+
+SOURCES += \
+    $$PWD/../src/cli/pumpsim.cpp
@@ -0,0 +1,18 @@
+# Link a target against the pump core (include from app / cli)
+INCLUDEPATH += $$PWD/..
+
+# Must match the core build (see core.pro)
+CONFIG(instrumentation): DEFINES += PUMP_INSTRUMENTATION
+
+win32:CONFIG(release, debug|release): PUMPCORE_DIR = $$OUT_PWD/../core/release
+else:win32:CONFIG(debug, debug|release): PUMPCORE_DIR = $$OUT_PWD/../core/debug
+else: PUMPCORE_DIR = $$OUT_PWD/../core
+
+LIBS += -L$$PUMPCORE_DIR -lpumpcore
+win32-msvc*: PRE_TARGETDEPS += $$PUMPCORE_DIR/pumpcore.lib
+else: PRE_TARGETDEPS += $$PUMPCORE_DIR/libpumpcore.a
+
+# Logger runs a background thread
+unix: LIBS += -lpthread
+# TelemetryFeed uses shm_open
+linux: LIBS += -lrt
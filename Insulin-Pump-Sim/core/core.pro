@@ -0,0 +1,56 @@
+# Pump core: models, bolus / basal / ControlIQ logic and the simulation clock.
+# Plain C++17, no Qt modules.
+TEMPLATE = lib
+CONFIG += staticlib c++17
+CONFIG -= qt
+TARGET = pumpcore
+
+INCLUDEPATH += $$PWD/..
+
+# qmake CONFIG+=instrumentation turns on PUMP_TIME_HANDLER and EventTrace
+CONFIG(instrumentation): DEFINES += PUMP_INSTRUMENTATION
+
+SOURCES += \
+    $$files($$PWD/../src/models/*.cpp) \
+    $$PWD/../src/logic/alloccounter.cpp \
+    $$PWD/../src/logic/basalengine.cpp \
+    $$PWD/../src/logic/bolusmanager.cpp \
+    $$PWD/../src/logic/cgmimport.cpp \
+    $$PWD/../src/logic/cgmingest.cpp \
+    $$PWD/../src/logic/cgmpyramid.cpp \
+    $$PWD/../src/logic/controliq.cpp \
+    $$PWD/../src/logic/deliverywatchdog.cpp \
+    $$PWD/../src/logic/eventtrace.cpp \
+    $$PWD/../src/logic/handlertiming.cpp \
+    $$PWD/../src/logic/logger.cpp \
+    $$PWD/../src/logic/pumpsnapshot.cpp \
+    $$PWD/../src/logic/simclock.cpp \
+    $$PWD/../src/logic/startupmetrics.cpp \
+    $$PWD/../src/logic/telemetryfeed.cpp \
+    $$PWD/../src/logic/timeseriesstore.cpp \
+    $$PWD/../src/logic/tracecache.cpp \
+    $$PWD/../src/logic/usagestats.cpp
+
+HEADERS += \
+    $$files($$PWD/../src/models/*.h) \
+    $$PWD/../src/logic/alloccounter.h \
+    $$PWD/../src/logic/basalengine.h \
+    $$PWD/../src/logic/bolusmanager.h \
+    $$PWD/../src/logic/cgmimport.h \
+    $$PWD/../src/logic/cgmingest.h \
+    $$PWD/../src/logic/cgmpyramid.h \
+    $$PWD/../src/logic/controliq.h \
+    $$PWD/../src/logic/deliverywatchdog.h \
+    $$PWD/../src/logic/eventtrace.h \
+    $$PWD/../src/logic/handlertiming.h \
+    $$PWD/../src/logic/logger.h \
+    $$PWD/../src/logic/pumpsnapshot.h \
+    $$PWD/../src/logic/ringbuffer.h \
+    $$PWD/../src/logic/seqlock.h \
+    $$PWD/../src/logic/simclock.h \
+    $$PWD/../src/logic/spscring.h \
+    $$PWD/../src/logic/startupmetrics.h \
+    $$PWD/../src/logic/telemetryfeed.h \
+    $$PWD/../src/logic/timeseriesstore.h \
+    $$PWD/../src/logic/tracecache.h \
+    $$PWD/../src/logic/usagestats.h
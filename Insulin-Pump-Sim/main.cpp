@@ -1,10 +1,31 @@
 #include <QApplication>
 #include "src/views/mainwindow.h"
+#include "src/logic/logger.h"
+#include "src/logic/startupmetrics.h"
+#include "src/logic/eventtrace.h"
 
 int main(int argc, char *argv[])
 {
+    StartupMetrics::instance().begin();
+#ifdef PUMP_INSTRUMENTATION
+    // PUMP_TRACE=file.json records a timeline for chrome://tracing / Perfetto
+    if (qEnvironmentVariableIsSet("PUMP_TRACE")) {
+        EventTrace::instance().start(qgetenv("PUMP_TRACE").toStdString());
+        PUMP_TRACE_THREAD("main");
+    }
+#endif
     QApplication app(argc, argv);
-    MainWindow window;
-    window.show();
-    return app.exec();
+    StartupMetrics::instance().mark("qapplication");
+    int result;
+    {
+        MainWindow window;
+        StartupMetrics::instance().mark("main window");
+        window.show();
+        StartupMetrics::instance().mark("show");
+        result = app.exec();
+    }   // joins the delivery thread, which logs its CGM and watchdog stats
+    // Drain pending log messages before the sinks go away
+    Logger::instance().shutdown();
+    EventTrace::instance().stop();
+    return result;
 }
@@ -0,0 +1,332 @@
+//--------------------------------------------------------
+// PUMPBENCH (microbenchmarks for the pump computations)
+// Each case is calibrated until one sample takes at least
+// kMinSampleNs, then sampled kSamples times; the JSON report
+// gives per-operation min / median / max in nanoseconds so
+// runs from different releases can be diffed. Sized cases
+// (event log, profiles) run once per size.
+//--------------------------------------------------------
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+#include "src/models/profilemanager.h"
+#include "src/models/iob.h"
+#include "src/logic/bolusmanager.h"
+#include "src/logic/controliq.h"
+#include "src/logic/cgmpyramid.h"
+#include "src/logic/ringbuffer.h"
+#include "src/logic/datamanager.h"
+#include "src/logic/logger.h"
+
+namespace {
+
+constexpr int kSamples = 7;
+constexpr std::int64_t kMinSampleNs = 20 * 1000 * 1000;
+
+// Keep the optimizer from dropping a result
+template <typename T>
+void keep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+struct Result {
+    std::string name;
+    long long size;          // problem size, -1 when the case has none
+    long long iterations;    // per sample
+    double minNs;
+    double medianNs;
+    double maxNs;
+};
+
+struct Options {
+    std::string filter;
+    std::string output;      // JSON file, stdout when empty
+    bool quick = false;      // skip the 1M-event sizes
+};
+
+std::int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class Bench {
+public:
+    explicit Bench(const Options& options) : m_options(options) {}
+
+    bool wants(const std::string& name) const {
+        return m_options.filter.empty() || name.find(m_options.filter) != std::string::npos;
+    }
+
+    // op runs `iterations` operations and returns nothing
+    void run(const std::string& name, long long size, const std::function<void(long long)>& op) {
+        if (!wants(name))
+            return;
+        long long iterations = 1;
+        for (;;) {
+            std::int64_t start = nowNs();
+            op(iterations);
+            if (nowNs() - start >= kMinSampleNs || iterations >= (1LL << 30))
+                break;
+            iterations *= 2;
+        }
+        record(name, size, iterations, op);
+    }
+
+    // Whole-collection cases: op does `ops` operations once per sample,
+    // setup runs before each sample and is not timed
+    void runOnce(const std::string& name, long long size, long long ops,
+                 const std::function<void()>& setup, const std::function<void()>& op) {
+        if (!wants(name))
+            return;
+        record(name, size, ops, [&](long long) {
+            setup();
+            std::int64_t start = nowNs();
+            op();
+            m_excludedNs = nowNs() - start;
+        }, true);
+    }
+
+    bool quick() const { return m_options.quick; }
+    const std::vector<Result>& results() const { return m_results; }
+
+private:
+    void record(const std::string& name, long long size, long long iterations,
+                const std::function<void(long long)>& op, bool selfTimed = false) {
+        std::vector<double> perOp;
+        for (int s = 0; s < kSamples; s++) {
+            std::int64_t start = nowNs();
+            op(iterations);
+            std::int64_t elapsed = selfTimed ? m_excludedNs : nowNs() - start;
+            perOp.push_back(static_cast<double>(elapsed) / iterations);
+        }
+        std::sort(perOp.begin(), perOp.end());
+        m_results.push_back(Result{name, size, iterations, perOp.front(), perOp[perOp.size() / 2], perOp.back()});
+        std::fprintf(stderr, "%-48s %10lld  %14.1f ns/op\n", name.c_str(), size, perOp[perOp.size() / 2]);
+    }
+
+    Options m_options;
+    std::vector<Result> m_results;
+    std::int64_t m_excludedNs = 0;
+};
+
+void benchBolus(Bench& bench) {
+    Profile profile("bench", 1.0f, 10.0f, 2.0f, 6.0f);
+    IOB iob;
+    iob.updateIOB(1.5f);
+    BolusManager manager(&profile, &iob);
+    bench.run("BolusManager::calculateStandard", -1, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            BolusResult result = manager.calculateStandard(40.0 + (i & 63), 8.0 + (i & 7) * 0.5);
+            keep(result);
+        }
+    });
+    bench.run("BolusManager::calculateExtended", -1, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            ExtendedBolusParams params = manager.calculateExtended(6.0 + (i & 15), 60.0, 40.0, 3.0);
+            keep(params);
+        }
+    });
+}
+
+void benchControlIQ(Bench& bench) {
+    ControlIQ controlIQ;
+    bench.run("ControlIQ::adjustDelivery", -1, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            double rate = controlIQ.adjustDelivery(3.0 + (i & 127) * 0.1);
+            keep(rate);
+        }
+    });
+}
+
+void benchIOB(Bench& bench) {
+    IOB iob;
+    bench.run("IOB::decay", -1, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            if ((i & 63) == 0)
+                iob.updateIOB(20.0f);
+            iob.decay();
+            keep(iob.activeInsulin);
+        }
+    });
+    bench.run("IOB::updateIOB", -1, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            iob.updateIOB(static_cast<float>(i & 31));
+            keep(iob.activeInsulin);
+        }
+    });
+}
+
+void benchDataManager(Bench& bench) {
+    std::vector<long long> sizes = {10000, 100000};
+    if (!bench.quick())
+        sizes.push_back(1000000);
+    const QString events[] = {
+        "[BASAL] Basal delivery started.",
+        "[BOLUS] Immediate Bolus Delivered: 2.5 u",
+        "[SYSTEM] 🔋 Charging completed.",
+        "[PROFILE] Switched to profile: bench",
+    };
+    for (long long size : sizes) {
+        DataManager* manager = nullptr;
+        bench.runOnce("DataManager::logEvent", size, size,
+            [&]() { delete manager; manager = new DataManager(); },
+            [&]() {
+                for (long long i = 0; i < size; i++)
+                    manager->logEvent(events[i & 3]);
+            });
+        bench.runOnce("DataManager::getHistory", size, 1,
+            [&]() {
+                if (manager && manager->eventCount() == size)
+                    return;
+                delete manager;
+                manager = new DataManager();
+                for (long long i = 0; i < size; i++)
+                    manager->logEvent(events[i & 3]);
+            },
+            [&]() {
+                QString history = manager->getHistory();
+                keep(history);
+            });
+        delete manager;
+    }
+}
+
+void benchProfiles(Bench& bench) {
+    for (long long size : {1000LL, 10000LL, 100000LL}) {
+        if (!bench.wants("ProfileManager::selectProfile"))
+            return;
+        ProfileManager manager;
+        std::vector<std::string> names;
+        names.reserve(size);
+        for (long long i = 0; i < size; i++) {
+            names.push_back("profile-" + std::to_string(i));
+            manager.createProfile(Profile(names.back(), 1.0f, 10.0f, 2.0f, 6.0f));
+        }
+        // Visit names in a scattered order so the lookups miss the cache
+        std::uint64_t state = 88172645463325252ULL;
+        bench.run("ProfileManager::selectProfile", size, [&](long long n) {
+            for (long long i = 0; i < n; i++) {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                Profile* profile = manager.selectProfile(names[state % names.size()]);
+                keep(profile);
+            }
+        });
+    }
+}
+
+// HomeScreenWidget::updateGraph -> CgmChartWidget::addReading + one
+// render query. The Qt painting is left out; this is the data path.
+void benchGraph(Bench& bench) {
+    const std::int64_t stepMs = 30 * 60 * 1000;
+    const std::size_t maxPoints = 2000;
+    const std::int64_t windows[] = {6LL * 60 * 60 * 1000, CgmPyramid::kRetentionMs};
+    for (std::int64_t windowMs : windows) {
+        CgmPyramid pyramid;
+        RingBuffer<PyramidPoint> samples(static_cast<std::size_t>(CgmPyramid::kRetentionMs / stepMs));
+        std::int64_t clockMs = 0;
+        // Full series: 90 days of readings already on the chart
+        for (std::int64_t t = 0; t < CgmPyramid::kRetentionMs; t += stepMs) {
+            clockMs = t;
+            float value = 7.0f + static_cast<float>((t / stepMs) % 40) * 0.1f;
+            samples.push({clockMs, value});
+            pyramid.add(clockMs, value);
+        }
+        std::string name = windowMs == CgmPyramid::kRetentionMs ? "HomeScreenWidget::updateGraph (90 d view)"
+                                                                 : "HomeScreenWidget::updateGraph (6 h view)";
+        bench.run(name, static_cast<long long>(samples.size()), [&](long long n) {
+            for (long long i = 0; i < n; i++) {
+                clockMs += stepMs;
+                float value = 7.0f + static_cast<float>(i % 40) * 0.1f;
+                samples.push({clockMs, value});
+                pyramid.add(clockMs, value);
+                PyramidView view = pyramid.query(clockMs - windowMs, clockMs, maxPoints);
+                keep(view.line.size());
+            }
+        });
+    }
+}
+
+void writeJson(std::FILE* out, const std::vector<Result>& results) {
+    std::fprintf(out, "{\n  \"suite\": \"pumpbench\",\n  \"schema\": 1,\n");
+#if defined(__clang__)
+    std::fprintf(out, "  \"compiler\": \"clang %s\",\n", __clang_version__);
+#elif defined(__GNUC__)
+    std::fprintf(out, "  \"compiler\": \"gcc %s\",\n", __VERSION__);
+#else
+    std::fprintf(out, "  \"compiler\": \"unknown\",\n");
+#endif
+#ifdef NDEBUG
+    std::fprintf(out, "  \"build\": \"release\",\n");
+#else
+    std::fprintf(out, "  \"build\": \"debug\",\n");
+#endif
+    std::fprintf(out, "  \"samples\": %d,\n  \"results\": [\n", kSamples);
+    for (std::size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        std::fprintf(out, "    {\"name\": \"%s\", ", r.name.c_str());
+        if (r.size >= 0)
+            std::fprintf(out, "\"size\": %lld, ", r.size);
+        else
+            std::fprintf(out, "\"size\": null, ");
+        std::fprintf(out, "\"iterations\": %lld, \"ns_per_op\": {\"min\": %.2f, \"median\": %.2f, \"max\": %.2f}}%s\n",
+                     r.iterations, r.minNs, r.medianNs, r.maxNs, i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+}
+
+void usage() {
+    std::printf("usage: pumpbench [options]\n"
+                "  --filter TEXT   only cases whose name contains TEXT\n"
+                "  --json FILE     write results to FILE (default stdout)\n"
+                "  --quick         skip the 1M-event DataManager sizes\n");
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            options.quick = true;
+        } else if (value && std::strcmp(argv[i], "--filter") == 0) {
+            options.filter = value; i++;
+        } else if (value && std::strcmp(argv[i], "--json") == 0) {
+            options.output = value; i++;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    Bench bench(options);
+    benchBolus(bench);
+    benchControlIQ(bench);
+    benchIOB(bench);
+    benchDataManager(bench);
+    benchProfiles(bench);
+    benchGraph(bench);
+
+    std::FILE* out = options.output.empty() ? stdout : std::fopen(options.output.c_str(), "w");
+    if (!out) {
+        std::fprintf(stderr, "cannot write %s\n", options.output.c_str());
+        return 1;
+    }
+    writeJson(out, bench.results());
+    if (out != stdout)
+        std::fclose(out);
+    Logger::instance().shutdown();
+    return 0;
+}
@@ -0,0 +1,236 @@
+//--------------------------------------------------------
+// PUMPSIM (headless batch runner)
+// Runs basal delivery on the pump core with a simulated
+// clock: no Qt, no display, one tick per simulated hour.
+//--------------------------------------------------------
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "src/models/profilemanager.h"
+#include "src/models/battery.h"
+#include "src/models/insulincartridge.h"
+#include "src/models/iob.h"
+#include "src/models/cgmsensor.h"
+#include "src/logic/basalengine.h"
+#include "src/logic/simclock.h"
+#include "src/logic/usagestats.h"
+#include "src/logic/logger.h"
+#include "src/logic/telemetryfeed.h"
+#include "src/logic/tracecache.h"
+#include "src/logic/eventtrace.h"
+#include "src/logic/alloccounter.h"
+
+namespace {
+
+struct Options {
+    int hours = 24;
+    float basal = 1.0f;
+    float carbRatio = 10.0f;
+    float correction = 2.0f;
+    float target = 6.0f;
+    float glucose = 8.0f;
+    bool mains = true;    // keep the battery topped up; --battery drains it
+    bool quiet = false;
+    std::string telemetry;   // shm segment to publish each tick into
+    std::string cgm;         // dataset that drives the sensor
+    std::string trace;       // Chrome trace-event output
+    bool checkAllocations = false;
+};
+
+const char* statusName(BasalStatus status) {
+    switch (status) {
+    case BasalStatus::Delivered:       return "delivered";
+    case BasalStatus::NoProfile:       return "no profile";
+    case BasalStatus::InvalidRate:     return "invalid basal rate";
+    case BasalStatus::BatteryDrained:  return "battery drained";
+    case BasalStatus::CgmDisconnected: return "CGM disconnected";
+    case BasalStatus::Occluded:        return "occlusion";
+    case BasalStatus::LowGlucose:      return "CGM too low";
+    }
+    return "unknown";
+}
+
+void usage() {
+    std::printf("usage: pumpsim [options]\n"
+                "  --hours N          simulated hours to run (default 24)\n"
+                "  --basal U          basal rate u/hr (default 1.0)\n"
+                "  --carb-ratio G     g per unit (default 10)\n"
+                "  --correction MMOL  mmol/L per unit (default 2)\n"
+                "  --target MMOL      target glucose (default 6.0)\n"
+                "  --glucose MMOL     starting CGM reading (default 8.0)\n"
+                "  --battery          run on battery (10%% per hour) instead of mains power;\n"
+                "                     basal suspends when it is drained\n"
+                "  --mains            keep the battery charged (default)\n"
+                "  --quiet            summary only\n"
+                "  --telemetry NAME   publish state to shared memory NAME\n"
+                "  --cgm FILE         replay CGM readings (CSV, OhioT1DM XML, Nightscout / Tidepool JSON)\n"
+                "  --trace FILE       write a chrome://tracing / Perfetto timeline (instrumentation builds)\n"
+                "  --check-allocs     run ticks through the event log and sample ring as the pump does,\n"
+                "                     fail if a steady-state tick allocates (instrumentation builds)\n"
+                "exit status: 0 ran to the end, 1 basal suspended (fault or drained battery),\n"
+                "             2 bad arguments or input, 3 a steady-state tick allocated\n");
+}
+
+bool parse(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (std::strcmp(arg, "--mains") == 0) {
+            options.mains = true;
+        } else if (std::strcmp(arg, "--battery") == 0) {
+            options.mains = false;
+        } else if (std::strcmp(arg, "--quiet") == 0) {
+            options.quiet = true;
+        } else if (std::strcmp(arg, "--check-allocs") == 0) {
+            options.checkAllocations = true;
+        } else if (value && std::strcmp(arg, "--hours") == 0) {
+            options.hours = std::atoi(value); i++;
+        } else if (value && std::strcmp(arg, "--basal") == 0) {
+            options.basal = std::strtof(value, nullptr); i++;
+        } else if (value && std::strcmp(arg, "--carb-ratio") == 0) {
+            options.carbRatio = std::strtof(value, nullptr); i++;
+        } else if (value && std::strcmp(arg, "--correction") == 0) {
+            options.correction = std::strtof(value, nullptr); i++;
+        } else if (value && std::strcmp(arg, "--target") == 0) {
+            options.target = std::strtof(value, nullptr); i++;
+        } else if (value && std::strcmp(arg, "--glucose") == 0) {
+            options.glucose = std::strtof(value, nullptr); i++;
+        } else if (value && std::strcmp(arg, "--telemetry") == 0) {
+            options.telemetry = value; i++;
+        } else if (value && std::strcmp(arg, "--cgm") == 0) {
+            options.cgm = value; i++;
+        } else if (value && std::strcmp(arg, "--trace") == 0) {
+            options.trace = value; i++;
+        } else {
+            return false;
+        }
+    }
+    return options.hours >= 0;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    auto wallStart = std::chrono::steady_clock::now();
+    Options options;
+    if (!parse(argc, argv, options)) {
+        usage();
+        return 2;
+    }
+
+    if (options.checkAllocations && !AllocationCounter::active()) {
+        std::printf("--check-allocs needs an instrumentation build (CONFIG+=instrumentation)\n");
+        return 2;
+    }
+
+    if (!options.trace.empty()) {
+        EventTrace::instance().start(options.trace);
+        PUMP_TRACE_THREAD("main");
+    }
+
+    ProfileManager profiles;
+    ProfileHandle profile = profiles.createProfile(
+        Profile("pumpsim", options.basal, options.carbRatio, options.correction, options.target));
+    Battery battery;
+    InsulinCartridge cartridge;
+    IOB iob;
+    CGMSensor sensor;
+    sensor.updateGlucoseData(options.glucose);
+
+    BasalEngine engine(&profiles, profile, &battery, &cartridge, &iob, &sensor);
+    SimClock clock;
+    UsageStats stats;
+    if (options.cgm.empty())
+        stats.addGlucose(sensor.getGlucoseLevel(), clock.nowMs());
+
+    TelemetryFeed telemetry;
+    if (!options.telemetry.empty() && !telemetry.open(options.telemetry)) {
+        std::printf("cannot open telemetry segment %s\n", options.telemetry.c_str());
+        return 2;
+    }
+
+    // Dataset time is replayed relative to its first reading, from the mapped cache
+    TraceCache trace;
+    if (!options.cgm.empty() && !trace.load(options.cgm)) {
+        std::printf("cannot read CGM dataset %s\n", options.cgm.c_str());
+        return 2;
+    }
+    TraceSpan<std::int64_t> times = trace.timestamps();
+    TraceSpan<float> readings = trace.glucose();
+    std::size_t nextReading = 0;
+    auto replayUntil = [&](std::int64_t simMs) {
+        for (; nextReading < times.size() && times[nextReading] - times[0] <= simMs; nextReading++) {
+            sensor.updateGlucoseData(readings[nextReading]);
+            stats.addGlucose(readings[nextReading], times[nextReading] - times[0]);
+        }
+    };
+    replayUntil(clock.nowMs());
+
+    BasalStatus status = engine.canStart();
+    int hour = 0;
+    // The first tick may warm up lazily allocated state; after it a tick allocates nothing
+    BasalSampleRing samples;
+    std::uint64_t steadyAllocations = 0;
+    std::uint64_t worstTickAllocations = 0;
+    for (; status == BasalStatus::Delivered && hour < options.hours; hour++) {
+        AllocationScope allocations;
+        if (options.mains)
+            battery.level = 100;
+        if (!options.cgm.empty())
+            replayUntil(clock.nowMs() + SimClock::kTickSimMs);
+        BasalTickResult result = engine.tick();
+        status = result.status;
+        clock.tick();
+        // Same hand-off as BasalManager -> DeliveryThread: Logger slot, then the sample ring
+        if (options.checkAllocations)
+            BasalEngine::logTick(result);
+        if (status != BasalStatus::Delivered)
+            break;
+        samples.tryPush(BasalSample{result.delivered, result.glucose});
+        BasalSample sample;
+        while (samples.tryPop(sample)) {
+            stats.addBasal(sample.units, clock.nowMs());
+            if (options.cgm.empty())
+                stats.addGlucose(sample.glucose, clock.nowMs());
+        }
+        if (telemetry.isOpen()) {
+            PumpSnapshot snapshot = PumpSnapshot::capture(battery, cartridge, iob, sensor);
+            snapshot.basalState = BasalState::Running;
+            snapshot.basalRate = result.rate;
+            telemetry.publish(TelemetryState::from(snapshot, clock.nowMs()));
+        }
+        if (hour > 0) {
+            steadyAllocations += allocations.count();
+            worstTickAllocations = std::max<std::uint64_t>(worstTickAllocations, allocations.count());
+        }
+        if (!options.quiet)
+            std::printf("%4dh  basal %.2f u  cgm %.1f mmol/L  iob %.1f u  insulin %d u  battery %d%%\n",
+                        hour + 1, result.units, result.glucose, iob.getIOB(),
+                        cartridge.getInsulinLevel(), battery.getStatus());
+    }
+    if (status != BasalStatus::Delivered)
+        std::printf("basal suspended after %d h: %s\n", hour, statusName(status));
+
+    if (!options.cgm.empty())
+        std::printf("CGM dataset: %zu readings (%s), %zu replayed\n",
+                    trace.rows(), trace.rebuilt() ? "imported" : "cached", nextReading);
+
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart).count();
+    std::printf("simulated %d h | basal %.2f u | mean CGM %.1f mmol/L | TIR %.1f%% | TBR %.1f%% | TAR %.1f%% | %.2f ms\n",
+                hour, stats.totalBasal(), stats.meanGlucose(), stats.timeInRangePct(),
+                stats.timeBelowRangePct(), stats.timeAboveRangePct(), wallMs);
+    if (AllocationCounter::active() && hour > 1)
+        std::printf("heap allocations: %.2f per simulated hour, worst tick %llu (steady state)\n",
+                    static_cast<double>(steadyAllocations) / (hour - 1),
+                    static_cast<unsigned long long>(worstTickAllocations));
+
+    Logger::instance().shutdown();
+    if (!options.trace.empty() && !EventTrace::instance().stop())
+        std::printf("cannot write trace %s\n", options.trace.c_str());
+    if (options.checkAllocations && steadyAllocations > 0)
+        return 3;
+    return status == BasalStatus::Delivered ? 0 : 1;
+}
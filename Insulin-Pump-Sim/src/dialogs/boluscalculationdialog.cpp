@@ -5,7 +5,7 @@
 #include <QFormLayout>
 #include <QHBoxLayout>
 #include <QMessageBox>
-#include <iostream>
+#include "src/logic/logger.h"
 
 // Constructor
 BolusCalculationDialog::BolusCalculationDialog(Profile* profile, IOB* iob, InsulinCartridge* cartridge, CGMSensor* sensor, QWidget* parent)
@@ -68,7 +68,7 @@ BolusCalculationDialog::BolusCalculationDialog(Profile* profile, IOB* iob, Insul
     connect(cancelButton2, &QPushButton::clicked, this, &QDialog::reject);
     connect(calculateButton, &QPushButton::clicked, this, &BolusCalculationDialog::calculateBolus);
     connect(manualButton, &QPushButton::clicked, this, [this]() {
-        std::cout << "[BolusCalculationDialog] Manual Bolus selected.\n";
+        Logger::instance().logf(LogChannel::Console, "[BolusCalculationDialog] Manual Bolus selected.");
         emit immediateBolusParameters(m_finalBolus);
         accept();
     });
@@ -85,12 +85,7 @@ BolusCalculationDialog::BolusCalculationDialog(Profile* profile, IOB* iob, Insul
             extendedDose  = ext.extendedDose;
             double currentRate = ext.ratePerHour;
 
-            // Update insulin and IOB
-            if (m_iob)
-                m_iob->updateIOB(m_iob->getIOB() + immediateDose);
-            if (m_cartridge)
-                m_cartridge->updateInsulinLevel(m_cartridge->getInsulinLevel() - immediateDose);
-
+            // The receiver delivers the immediate part (on the delivery thread)
             emit extendedBolusParameters(duration, immediateDose, extendedDose, currentRate);
             accept();
         }
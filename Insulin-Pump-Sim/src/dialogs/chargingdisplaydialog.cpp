@@ -1,5 +1,5 @@
 #include "chargingdisplaydialog.h"
-#include <iostream>
+#include "src/logic/logger.h"
 
 ChargingDisplayDialog::ChargingDisplayDialog(Battery* battery, QWidget* parent)
     : QDialog(parent), m_battery(battery)
@@ -24,7 +24,7 @@ void ChargingDisplayDialog::onTimeout() {
     if(m_battery->level < 100) {
         m_battery->charge();
         batteryLabel->setText("Battery Level: " + QString::number(m_battery->getStatus()));
-        std::cout << "[ChargingDisplayDialog] Battery level: " << m_battery->getStatus() << "\n";
+        Logger::instance().logf(LogChannel::Console, "[ChargingDisplayDialog] Battery level: %d", m_battery->getStatus());
     } else {
         m_timer->stop();
     }
@@ -1,4 +1,5 @@
 #include "newprofiledialog.h"
+#include "src/models/profile.h"
 
 NewProfileDialog::NewProfileDialog(QWidget* parent) : QDialog(parent) {
     initializeUI("Create New Profile");
@@ -42,6 +43,7 @@ void NewProfileDialog::initializeUI(const QString& title) {
     setWindowTitle(title);
     QFormLayout* formLayout = new QFormLayout(this);
     nameEdit = new QLineEdit(this);
+    nameEdit->setMaxLength(static_cast<int>(Profile::kMaxNameLength));
     basalEdit = new QLineEdit(this);
     carbEdit = new QLineEdit(this);
     correctionEdit = new QLineEdit(this);
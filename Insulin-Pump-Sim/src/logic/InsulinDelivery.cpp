@@ -3,197 +3,359 @@
 #include <QMessageBox>
 #include <QTimer>
 #include <QWidget>
+#include "handlertiming.h"
+#include "logger.h"
+#include <algorithm>
 
-InsulinDelivery::InsulinDelivery(Profile*& currentProfile,
+InsulinDelivery::InsulinDelivery(ProfileManager* profileManager,
+                                                     ProfileHandle& currentProfile,
                                                      Battery* battery,
                                                      InsulinCartridge* cartridge,
                                                      IOB* iob,
                                                      CGMSensor* sensor,
+                                                     DataManager* dataManager,
+                                                     DeliveryThread* delivery,
                                                      std::function<void(const QString&)> addLogCallback,
-                                                     std::function<void()> updateStatusCallback,
                                                      std::function<void(const QString&)> updateBasalStatusCallback,
                                                      QObject* parent)
     : QObject(parent),
+    m_profileManager(profileManager),
     m_currentProfile(currentProfile),
     m_battery(battery),
     m_cartridge(cartridge),
     m_iob(iob),
     m_sensor(sensor),
+    m_dataManager(dataManager),
+    m_delivery(delivery),
     m_addLog(addLogCallback),
-    m_updateStatus(updateStatusCallback),
     m_updateBasalStatus(updateBasalStatusCallback),
-    m_basalManager(nullptr),
-    m_basalRunning(false),
-    m_basalPaused(false)
+    m_basalStarted(false),
+    m_basalManager(nullptr)
 {
+    // Runs on the watchdog thread; the alarm goes straight to the logger and
+    // the stop straight to the delivery thread, so a busy GUI cannot hold it up
+    m_delivery->watchdog().setMissHandler([this](const std::string& task, std::int64_t lateMs) {
+        Logger::instance().logf(LogChannel::Event,
+                                "[SYSTEM] ⚠️ Watchdog: %s missed its deadline by %lld ms -> stopping all delivery",
+                                task.c_str(), static_cast<long long>(lateMs));
+        m_delivery->post([this]() {
+            haltDelivery();
+            m_delivery->toUi([this]() { reportStopped("Watchdog"); });
+        });
+    });
+}
+
+Profile* InsulinDelivery::currentProfile() const {
+    return m_profileManager->get(m_currentProfile);
 }
 
 void InsulinDelivery::launchBolusDialog(QWidget* parentWidget) {
-    BolusCalculationDialog dlg(m_currentProfile, m_iob, m_cartridge, m_sensor, parentWidget);
+    // The dialog calculates from a copy of the current state;
+    // the doses it returns are applied on the delivery thread
+    PumpSnapshot state = m_delivery->snapshot();
+    IOB iob;
+    iob.updateIOB(state.iob);
+    InsulinCartridge cartridge;
+    cartridge.updateInsulinLevel(state.insulin);
+    CGMSensor sensor;
+    sensor.updateGlucoseData(state.glucose);
+    Profile* profile = currentProfile();
+    double targetBG = profile ? profile->getTargetGlucose() : 5.0;
+
+    BolusCalculationDialog dlg(profile, &iob, &cartridge, &sensor, parentWidget);
     connect(&dlg, &BolusCalculationDialog::mealInfoEntered, parentWidget, [=](double newBG) {
-        m_sensor->updateGlucoseData(newBG);
-        m_updateStatus();
-        QTimer* mealRiseTimer = new QTimer(parentWidget);
-        connect(mealRiseTimer, &QTimer::timeout, parentWidget, [=]() {
-            float currentBG = m_sensor->getGlucoseLevel();
-            float targetMealBG = newBG + 2.0f;
-            if (currentBG < targetMealBG) {
-                m_sensor->updateGlucoseData(currentBG + 0.5f);
-                m_updateStatus();
-                m_addLog(QString("🍔 Meal Eaten: CGM increased to %1 mmol/L").arg(m_sensor->getGlucoseLevel(), 0, 'f', 1));
-            } else {
-                mealRiseTimer->stop();
-                mealRiseTimer->deleteLater();
+        PUMP_TIME_HANDLER("InsulinDelivery::mealInfoEntered");
+        m_delivery->post([=]() {
+            m_sensor->updateGlucoseData(newBG);
+            recordData([newBG](DataManager* data) { data->recordGlucose(newBG); });
+            startTask("meal rise", 5000, [=]() {
+                PUMP_TIME_HANDLER("InsulinDelivery::mealRiseTimer");
+                float currentBG = m_sensor->getGlucoseLevel();
+                float targetMealBG = newBG + 2.0f;
+                if (currentBG < targetMealBG) {
+                    m_sensor->updateGlucoseData(currentBG + 0.5f);
+                    float level = m_sensor->getGlucoseLevel();
+                    recordData([level](DataManager* data) { data->recordGlucose(level); });
+                    m_delivery->publish();
+                    m_addLog(QString("🍔 Meal Eaten: CGM increased to %1 mmol/L").arg(level, 0, 'f', 1));
+                    return true;
+                }
                 m_addLog("📈 CGM rise finished.");
-            }
+                return false;
+            });
         });
-        mealRiseTimer->start(5000);
     });
     connect(&dlg, &BolusCalculationDialog::extendedBolusParameters, parentWidget, [=](double duration, double immediateDose, double extendedDose, double ratePerHour) {
+        PUMP_TIME_HANDLER("InsulinDelivery::extendedBolusStarted");
         int totalTicks = static_cast<int>(duration);
         m_addLog(QString("[BOLUS] Starting Extended Bolus Delivery... Immediate: %1 u, Extended: %2 u over %3 hrs at %4 u/hr")
                      .arg(immediateDose)
                      .arg(extendedDose)
                      .arg(totalTicks)
                      .arg(ratePerHour, 0, 'f', 2));
-        QTimer* timer = new QTimer(parentWidget);
-        int* tick = new int(0);
-        connect(timer, &QTimer::timeout, parentWidget, [=]() mutable {
-            if (*tick < totalTicks) {
-                if (m_iob)
-                    m_iob->updateIOB(m_iob->getIOB() + ratePerHour);
-                if (m_cartridge)
-                    m_cartridge->updateInsulinLevel(m_cartridge->getInsulinLevel() - ratePerHour);
-                m_updateStatus();
-                m_addLog(QString("[BOLUS] %1/%2 hrs | +%3 u delivered (extended)")
-                             .arg(*tick + 1)
-                             .arg(totalTicks)
-                             .arg(ratePerHour, 0, 'f', 2));
-                (*tick)++;
-            } else {
-                timer->stop();
-                timer->deleteLater();
-                delete tick;
+        m_delivery->post([=]() {
+            // Immediate part
+            MicroUnits immediate = dose(immediateDose);
+            recordData([immediate](DataManager* data) { data->recordBolus(immediate, true); });
+
+            int tick = 0;
+            startTask("extended bolus", 10000, [=]() mutable {
+                PUMP_TIME_HANDLER("InsulinDelivery::extendedBolusTimer");
+                if (tick < totalTicks) {
+                    MicroUnits step = dose(ratePerHour);
+                    recordData([step](DataManager* data) { data->recordExtendedBolusStep(step); });
+                    m_delivery->publish();
+                    m_addLog(QString("[BOLUS] %1/%2 hrs | +%3 u delivered (extended)")
+                                 .arg(tick + 1)
+                                 .arg(totalTicks)
+                                 .arg(ratePerHour, 0, 'f', 2));
+                    tick++;
+                    return true;
+                }
                 m_addLog("[BOLUS] ✅ Extended Bolus Completed");
-            }
-        });
-        timer->start(10000);
-        QTimer* cgmTimer = new QTimer(parentWidget);
-        connect(cgmTimer, &QTimer::timeout, parentWidget, [=]() {
-            double currentBG = m_sensor->getGlucoseLevel();
-            double targetBG = (m_currentProfile) ? m_currentProfile->getTargetGlucose() : 5.0;
-            if (currentBG > targetBG) {
-                double updated = currentBG - 0.5;
-                if (updated < targetBG)
-                    updated = targetBG;
-                m_sensor->updateGlucoseData(updated);
-                m_updateStatus();
-                m_addLog(QString("[BOLUS] CGM: %1 mmol/L").arg(updated, 0, 'f', 2));
-            } else {
-                cgmTimer->stop();
-                cgmTimer->deleteLater();
+                return false;
+            }, true);
+            startTask("extended bolus CGM", 10000, [=]() {
+                PUMP_TIME_HANDLER("InsulinDelivery::extendedBolusCgmTimer");
+                double currentBG = m_sensor->getGlucoseLevel();
+                if (currentBG > targetBG) {
+                    double updated = currentBG - 0.5;
+                    if (updated < targetBG)
+                        updated = targetBG;
+                    m_sensor->updateGlucoseData(updated);
+                    recordData([updated](DataManager* data) { data->recordGlucose(updated); });
+                    m_delivery->publish();
+                    m_addLog(QString("[BOLUS] CGM: %1 mmol/L").arg(updated, 0, 'f', 2));
+                    return true;
+                }
                 m_addLog("[BOLUS] ✅ CGM @ Target: Complete");
-            }
+                return false;
+            });
         });
-        cgmTimer->start(10000);
     });
     connect(&dlg, &BolusCalculationDialog::immediateBolusParameters, parentWidget, [=](double bolus) {
-        if (m_cartridge && m_cartridge->getInsulinLevel() < bolus) {
-            QMessageBox::warning(parentWidget, "Insufficient Insulin",
-                                 "Not enough insulin in the cartridge for this bolus.");
+        deliverBolus(bolus, parentWidget);
+    });
+    dlg.exec();
+}
+
+void InsulinDelivery::deliverBolus(double bolus, QWidget* parentWidget) {
+    PUMP_TIME_HANDLER("InsulinDelivery::deliverBolus");
+    Profile* profile = currentProfile();
+    double targetBG = profile ? profile->getTargetGlucose() : 5.0;
+    m_delivery->post([=]() {
+        if (m_cartridge && m_cartridge->getInsulin() < InsulinUnits::fromUnits(bolus)) {
+            if (!parentWidget) {
+                m_addLog(QString("[BOLUS] Not enough insulin in the cartridge for %1 u").arg(bolus, 0, 'f', 1));
+                return;
+            }
+            // Non-modal, so neither thread waits for the user to close it
+            m_delivery->toUi([parentWidget]() {
+                QMessageBox* box = new QMessageBox(QMessageBox::Warning, "Insufficient Insulin",
+                                                   "Not enough insulin in the cartridge for this bolus.",
+                                                   QMessageBox::Ok, parentWidget);
+                box->setAttribute(Qt::WA_DeleteOnClose);
+                box->open();
+            });
             return;
         }
-        if (m_iob)
-            m_iob->updateIOB(m_iob->getIOB() + bolus);
-        if (m_cartridge) {
-            int newLevel = m_cartridge->getInsulinLevel() - static_cast<int>(bolus);
-            m_cartridge->updateInsulinLevel(newLevel > 0 ? newLevel : 0);
-        }
+        MicroUnits delivered = dose(bolus);
         if (m_battery)
             m_battery->discharge();
+        recordData([delivered](DataManager* data) { data->recordBolus(delivered); });
         m_addLog(QString("[BOLUS] Immediate Bolus Delivered: %1 u").arg(bolus, 0, 'f', 1));
-        m_updateStatus();
-        QTimer* cgmTimer = new QTimer(parentWidget);
-        connect(cgmTimer, &QTimer::timeout, parentWidget, [=]() {
+        startTask("immediate bolus CGM", 10000, [=]() {
+            PUMP_TIME_HANDLER("InsulinDelivery::immediateBolusCgmTimer");
             double currentBG = m_sensor->getGlucoseLevel();
-            double targetBG = (m_currentProfile) ? m_currentProfile->getTargetGlucose() : 5.0;
             if (currentBG > targetBG) {
                 double updated = currentBG - 0.5;
                 if (updated < targetBG)
                     updated = targetBG;
                 m_sensor->updateGlucoseData(updated);
-                m_updateStatus();
+                recordData([updated](DataManager* data) { data->recordGlucose(updated); });
+                m_delivery->publish();
                 m_addLog(QString("[BOLUS] CGM updated: %1 mmol/L").arg(updated, 0, 'f', 2));
-            } else {
-                cgmTimer->stop();
-                cgmTimer->deleteLater();
-                m_addLog("[BOLUS] ✅ CGM simulation complete.");
+                return true;
             }
+            m_addLog("[BOLUS] ✅ CGM simulation complete.");
+            return false;
         });
-        cgmTimer->start(10000);
     });
-    dlg.exec();
 }
 
 void InsulinDelivery::toggleBasalDelivery() {
-    if (!m_currentProfile) {
+    PUMP_TIME_HANDLER("InsulinDelivery::toggleBasalDelivery");
+    Profile* profile = currentProfile();
+    if (!profile) {
         QMessageBox::warning(nullptr, "Basal Delivery", "No profile loaded.");
         return;
     }
-    if (m_basalManager == nullptr) {
-        m_basalManager = new BasalManager(m_currentProfile, m_battery, m_cartridge, m_iob, m_sensor, this);
-        m_basalManager->startBasalDelivery(
-            [this](const QString& msg){ m_addLog(msg); },
-            [this](){ m_updateStatus(); },
-            [this](const QString& status){ m_updateBasalStatus(status); }
-            );
-        m_basalRunning = true;
-        m_basalPaused = false;
+    // Nothing to resume after a failed start, a stop (crash, watchdog)
+    // or deletion of the basal's profile: start over on the current one
+    BasalState state = m_delivery->snapshot().basalState;
+    if (!m_basalStarted || state == BasalState::Stopped || !m_profileManager->get(m_basalProfile)) {
+        restartBasal();
         m_addLog("[BASAL] Basal delivery started.");
-    } else if (m_basalRunning && !m_basalPaused) {
-        m_basalManager->pause();
-        m_basalPaused = true;
+        return;
+    }
+    // The delivery thread can pause basal on its own (battery, CGM, occlusion)
+    switch (state) {
+    case BasalState::Running:
+        m_delivery->post([this]() { m_basalManager->pause(); });
         m_addLog("[BASAL] Basal delivery paused.");
-    } else if (m_basalRunning && m_basalPaused) {
-        m_basalManager->resume();
-        m_basalPaused = false;
+        break;
+    case BasalState::Paused:
+        m_delivery->post([this]() { m_basalManager->resume(); });
         m_addLog("[BASAL] Basal delivery resumed.");
+        break;
+    case BasalState::Stopped:
+        break;
     }
 }
 
 void InsulinDelivery::startBasalDelivery() {
-    if (!m_currentProfile) {
+    if (!currentProfile()) {
         QMessageBox::warning(nullptr, "Basal Delivery", "No profile loaded.");
         return;
     }
-    if (m_battery && m_battery->getStatus() == 0) {
+    if (m_delivery->snapshot().battery == 0) {
         QMessageBox::warning(nullptr, "Basal Delivery", "🪫 NO BATTERY ->  Please charge the pump.");
         return;
     }
-    float rate = m_currentProfile->getBasalRate();
+    float rate = currentProfile()->getBasalRate();
     if (rate <= 0.0f) {
         QMessageBox::warning(nullptr, "Basal Delivery", "Set a valid basal rate in the profile to start delivery.");
         return;
     }
-    BasalManager* basalMgr = new BasalManager(m_currentProfile, m_battery, m_cartridge, m_iob, m_sensor, this);
-    basalMgr->startBasalDelivery(
-        [this](const QString &msg){ m_addLog(msg); },
-        [this](){ m_updateStatus(); },
-        [this](const QString &status){ m_updateBasalStatus(status); }
-        );
+    restartBasal();
+}
+
+void InsulinDelivery::restartBasal() {
+    m_basalProfile = m_currentProfile;
+    Profile copy = *currentProfile();
+    m_delivery->post([this, copy]() {
+        mirrorProfile(copy);
+        // A second start replaces the running manager instead of stacking another
+        if (m_basalManager) {
+            m_basalManager->stop();
+            m_basalManager->deleteLater();
+        }
+        m_basalManager = createBasalManager();
+        m_delivery->setBasalManager(m_basalManager);
+        // The manager refuses to start without battery, rate or profile
+        bool started = m_basalManager->state() != BasalState::Stopped;
+        m_delivery->toUi([this, started]() { m_basalStarted = started; });
+    });
 }
 
-void InsulinDelivery::setCurrentProfile(Profile* profile) {
+void InsulinDelivery::setCurrentProfile(ProfileHandle profile) {
     m_currentProfile = profile;
 }
 
-void InsulinDelivery::stopAllDelivery() {
-    if (m_basalManager) {
-        m_basalManager->stop();
-        m_basalRunning = false;
-        m_basalPaused = false;
-        m_updateBasalStatus("Basal stopped (System Crash)");
+void InsulinDelivery::syncProfile() {
+    if (!m_basalProfile.isValid())
+        return;
+    // A profile switch moves the basal onto the newly selected profile
+    if (m_currentProfile != m_basalProfile && m_profileManager->get(m_currentProfile))
+        m_basalProfile = m_currentProfile;
+    const Profile* profile = m_profileManager->get(m_basalProfile);
+    if (!profile) {
+        // Deleted: the next basal tick reports NoProfile and pauses
+        m_basalProfile = ProfileHandle();
+        m_delivery->post([this]() { m_deliveryProfiles.deleteProfile(m_deliveryProfile); });
+        return;
+    }
+    Profile copy = *profile;
+    m_delivery->post([this, copy]() { mirrorProfile(copy); });
+}
+
+void InsulinDelivery::stopAllDelivery(const QString& reason) {
+    PUMP_TIME_HANDLER("InsulinDelivery::stopAllDelivery");
+    m_delivery->post([this]() { haltDelivery(); });
+    reportStopped(reason);
+}
+
+void InsulinDelivery::reportStopped(const QString& reason) {
+    if (m_basalStarted) {
+        m_updateBasalStatus("Basal stopped (" + reason + ")");
         m_addLog("[BASAL] ⛔ All basal delivery stopped.");
     }
 }
 
+void InsulinDelivery::haltDelivery() {
+    if (m_basalManager)
+        m_basalManager->stop();
+    while (!m_tasks.empty())
+        finishTask(m_tasks.back().timer);
+}
+
+void InsulinDelivery::mirrorProfile(const Profile& profile) {
+    if (m_deliveryProfiles.get(m_deliveryProfile))
+        m_deliveryProfiles.updateProfile(m_deliveryProfile, profile.getBasalRate(), profile.getCarbRatio(),
+                                         profile.getCorrectionFactor(), profile.getTargetGlucose());
+    else
+        m_deliveryProfile = m_deliveryProfiles.createProfile(profile);
+}
+
+BasalManager* InsulinDelivery::createBasalManager() {
+    BasalManager* basalManager = new BasalManager(&m_deliveryProfiles, m_deliveryProfile, m_battery, m_cartridge,
+                                                  m_iob, m_sensor, m_dataManager, m_delivery, m_delivery->context());
+    basalManager->startBasalDelivery(
+        [this](const QString& msg){ m_addLog(msg); },
+        [this](){ m_delivery->publish(); },
+        [this](const QString& status){ setBasalStatus(status); }
+        );
+    return basalManager;
+}
+
+void InsulinDelivery::setBasalStatus(const QString& status) {
+    m_delivery->publish();
+    m_delivery->toUi([this, status]() { m_updateBasalStatus(status); });
+}
+
+void InsulinDelivery::recordData(std::function<void(DataManager*)> record) {
+    if (!m_dataManager)
+        return;
+    DataManager* dataManager = m_dataManager;
+    m_delivery->toUi([dataManager, record]() { record(dataManager); });
+}
+
+MicroUnits InsulinDelivery::dose(double units) {
+    MicroUnits amount = InsulinUnits::fromUnits(units);
+    MicroUnits delivered = m_cartridge ? m_cartridge->withdraw(amount) : amount;
+    if (m_iob)
+        m_iob->add(delivered);
+    return delivered;
+}
+
+void InsulinDelivery::startTask(const std::string& name, int periodMs, std::function<bool()> step, bool bolus) {
+    QTimer* timer = new QTimer(m_delivery->context());
+    int watchId = m_delivery->watchdog().watch(name, periodMs * DeliveryWatchdog::kDefaultMissFactor);
+    m_tasks.push_back(Task{timer, watchId, bolus});
+    if (bolus)
+        countActiveBoluses();
+    connect(timer, &QTimer::timeout, m_delivery->context(), [this, timer, watchId, step]() {
+        m_delivery->watchdog().heartbeat(watchId);
+        if (!step())
+            finishTask(timer);
+    });
+    timer->start(periodMs);
+}
+
+void InsulinDelivery::finishTask(QTimer* timer) {
+    auto it = std::find_if(m_tasks.begin(), m_tasks.end(), [timer](const Task& task) { return task.timer == timer; });
+    if (it == m_tasks.end())
+        return;
+    m_delivery->watchdog().release(it->watchId);
+    timer->stop();
+    timer->deleteLater();
+    bool bolus = it->bolus;
+    m_tasks.erase(it);
+    if (bolus)
+        countActiveBoluses();
+}
+
+void InsulinDelivery::countActiveBoluses() {
+    int count = static_cast<int>(std::count_if(m_tasks.begin(), m_tasks.end(), [](const Task& task) { return task.bolus; }));
+    m_delivery->setActiveBoluses(count);
+}
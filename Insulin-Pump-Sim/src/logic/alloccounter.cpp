@@ -0,0 +1,86 @@
+#include "alloccounter.h"
+
+#ifdef PUMP_INSTRUMENTATION
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+// Plain zero-initialised TLS: no constructor runs inside malloc
+thread_local std::uint64_t t_allocations = 0;
+}
+
+#if defined(__GLIBC__)
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* pointer, std::size_t size);
+
+void* malloc(std::size_t size) {
+    t_allocations++;
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size) {
+    t_allocations++;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, std::size_t size) {
+    t_allocations++;
+    return __libc_realloc(pointer, size);
+}
+}
+#else
+void* operator new(std::size_t size) {
+    t_allocations++;
+    for (;;) {
+        if (void* pointer = std::malloc(size ? size : 1))
+            return pointer;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    t_allocations++;
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return ::operator new(size, std::nothrow);
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+#endif
+
+bool AllocationCounter::active() {
+    return true;
+}
+
+std::uint64_t AllocationCounter::thisThread() {
+    return t_allocations;
+}
+
+#else
+
+bool AllocationCounter::active() {
+    return false;
+}
+
+std::uint64_t AllocationCounter::thisThread() {
+    return 0;
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef ALLOCCOUNTER_H
+#define ALLOCCOUNTER_H
+
+#include <cstdint>
+
+//--------------------------------------------------------
+// ALLOCATION COUNTER (heap allocations per thread)
+// Instrumentation builds count every heap allocation made by
+// each thread: on glibc malloc / calloc / realloc are wrapped,
+// which also covers operator new and Qt's containers;
+// elsewhere the global operator new is replaced. Used to hold
+// the steady-state delivery tick at zero allocations. Without
+// PUMP_INSTRUMENTATION nothing is hooked and counts stay 0.
+//--------------------------------------------------------
+class AllocationCounter {
+public:
+    // False when the build does not count (release builds)
+    static bool active();
+    // Allocations made by the calling thread so far
+    static std::uint64_t thisThread();
+};
+
+// Allocations made on this thread since construction
+class AllocationScope {
+public:
+    AllocationScope() : m_start(AllocationCounter::thisThread()) {}
+    std::uint64_t count() const { return AllocationCounter::thisThread() - m_start; }
+
+private:
+    std::uint64_t m_start;
+};
+
+#endif // ALLOCCOUNTER_H
@@ -0,0 +1,105 @@
+#include "basalengine.h"
+#include "handlertiming.h"
+#include "logger.h"
+
+BasalEngine::BasalEngine(ProfileManager* profileManager, ProfileHandle profile, Battery* battery,
+                         InsulinCartridge* cartridge, IOB* iob, CGMSensor* sensor)
+    : m_profileManager(profileManager),
+    m_profile(profile),
+    m_battery(battery),
+    m_cartridge(cartridge),
+    m_iob(iob),
+    m_sensor(sensor),
+    m_doseRemainder(0),
+    m_pendingDischarge(0.0)
+{}
+
+BasalStatus BasalEngine::canStart() const {
+    if (!m_profileManager->get(m_profile))
+        return BasalStatus::NoProfile;
+    if (m_battery && m_battery->getStatus() == 0)
+        return BasalStatus::BatteryDrained;
+    if (profileRate() <= 0.0f)
+        return BasalStatus::InvalidRate;
+    return BasalStatus::Delivered;
+}
+
+float BasalEngine::profileRate() const {
+    const Profile* profile = m_profileManager->get(m_profile);
+    return profile ? profile->getBasalRate() : 0.0f;
+}
+
+BasalTickResult BasalEngine::tick(std::int64_t simElapsedMs) {
+    PUMP_TIME_HANDLER("BasalEngine::tick");
+    BasalTickResult result{BasalStatus::Delivered, 0.0f, 0.0f, 0, 0.0f, false};
+    if (m_sensor)
+        result.glucose = m_sensor->getGlucoseLevel();
+
+    // Profile may have been deleted while delivering
+    const Profile* profile = m_profileManager->get(m_profile);
+    if (!profile) {
+        result.status = BasalStatus::NoProfile;
+        return result;
+    }
+    float rate = profile->getBasalRate();
+
+    // Battery Check
+    result.lowBattery = m_battery && m_battery->getStatus() <= kLowBattery;
+    if (m_battery && m_battery->getStatus() == 0) {
+        result.status = BasalStatus::BatteryDrained;
+        return result;
+    }
+
+    // CGM Disconnection / Occlusion
+    if (m_sensor && !m_sensor->isConnected()) {
+        result.status = BasalStatus::CgmDisconnected;
+        return result;
+    }
+    if (m_cartridge && m_cartridge->isOccluded()) {
+        result.status = BasalStatus::Occluded;
+        return result;
+    }
+
+    float cgm = m_sensor ? m_sensor->getGlucoseLevel() : 0.0f;
+    float adjustedRate = rate * m_controlIQ.adjustDelivery(cgm);
+    result.rate = adjustedRate;
+    if (cgm < kLowGlucose) {
+        result.status = BasalStatus::LowGlucose;
+        return result;
+    }
+
+    // Insulin Delivery Logic -> uU/hr x ms that passed / ms per hour
+    double hours = simElapsedMs > 0 ? static_cast<double>(simElapsedMs) / kMsPerHour : 0.0;
+    if (simElapsedMs > 0) {
+        std::int64_t owed = InsulinUnits::fromUnits(adjustedRate) * simElapsedMs + m_doseRemainder;
+        MicroUnits dose = owed / kMsPerHour;
+        m_doseRemainder = owed % kMsPerHour;
+        result.delivered = m_cartridge ? m_cartridge->withdraw(dose) : dose;
+    }
+    result.units = static_cast<float>(InsulinUnits::toUnits(result.delivered));
+    if (m_iob)
+        m_iob->add(result.delivered);
+    // Battery drains 10% per hour of delivery
+    m_pendingDischarge += hours;
+    for (; m_pendingDischarge >= 1.0; m_pendingDischarge -= 1.0) {
+        if (m_battery)
+            m_battery->discharge();
+    }
+    if (m_sensor) {
+        float newCGM = m_sensor->getGlucoseLevel() - 0.1f * static_cast<float>(hours);
+        if (newCGM < 2.5f) newCGM = 2.5f;
+        m_sensor->updateGlucoseData(newCGM);
+        result.glucose = newCGM;
+    }
+    return result;
+}
+
+void BasalEngine::logTick(const BasalTickResult& result) {
+    if (result.lowBattery) {
+        static const char kLowBatteryLog[] = "[SYSTEM] 🪫 Low Battery ->  Battery is low -> Deliverying final doses.";
+        Logger::instance().log(LogChannel::Event, kLowBatteryLog, sizeof(kLowBatteryLog) - 1);
+    }
+    if (result.status == BasalStatus::Delivered)
+        Logger::instance().logf(LogChannel::Event, "[BASAL] Basal Delivered: %.2f u | CGM: %.1f mmol/L",
+                                result.units, result.glucose);
+}
@@ -0,0 +1,86 @@
+#ifndef BASALENGINE_H
+#define BASALENGINE_H
+
+#include "src/models/profilemanager.h"
+#include "src/models/battery.h"
+#include "src/models/insulincartridge.h"
+#include "src/models/iob.h"
+#include "src/models/cgmsensor.h"
+#include "controliq.h"
+#include "simclock.h"
+#include "spscring.h"
+#include <cstdint>
+
+//--------------------------------------------------------
+// BASAL ENGINE (one basal tick, no Qt)
+// Safety checks, ControlIQ adjustment and the model updates
+// for one stretch of basal delivery. The dose is rate x the
+// simulated time that actually passed, so a late or stretched
+// tick delivers what is owed rather than a fixed amount. Doses
+// are integer micro-units (rate x ms / ms per hour); the part
+// of a micro-unit left by the division carries over to the
+// next tick, and an empty cartridge delivers nothing. BasalManager
+// drives it from a QTimer; pumpsim drives it from a SimClock.
+//--------------------------------------------------------
+enum class BasalStatus {
+    Delivered,
+    NoProfile,
+    InvalidRate,
+    BatteryDrained,
+    CgmDisconnected,
+    Occluded,
+    LowGlucose
+};
+
+struct BasalTickResult {
+    BasalStatus status;
+    float rate;        // u/hr after the ControlIQ adjustment
+    float units;       // delivered this tick (rate x elapsed hours)
+    MicroUnits delivered;   // the same, exact: taken from the cartridge into IOB
+    float glucose;     // CGM after the tick (mmol/L)
+    bool lowBattery;   // battery at or below 20% before the tick
+};
+
+// One basal tick's usage data, on its way from the delivery
+// thread to the usage stats; a full ring drops samples
+struct BasalSample {
+    MicroUnits units;
+    float glucose;
+};
+using BasalSampleRing = SpscRing<BasalSample, 256>;
+
+class BasalEngine {
+public:
+    static constexpr float kLowGlucose = 4.0f;   // suspend below this CGM
+    static constexpr int kLowBattery = 20;
+    // Rates are u/hr; an hour of pump time, whatever one tick stands for
+    static constexpr std::int64_t kMsPerHour = 3'600'000;
+
+    BasalEngine(ProfileManager* profileManager,
+                ProfileHandle profile,
+                Battery* battery,
+                InsulinCartridge* cartridge,
+                IOB* iob,
+                CGMSensor* sensor);
+
+    // Checks done once before delivery starts (profile, battery, rate)
+    BasalStatus canStart() const;
+    float profileRate() const;
+    // Deliver for simElapsedMs of simulated time (default: one hour)
+    BasalTickResult tick(std::int64_t simElapsedMs = SimClock::kTickSimMs);
+    // Event log lines for a tick (low battery, dose); no allocation
+    static void logTick(const BasalTickResult& result);
+
+private:
+    ProfileManager* m_profileManager;
+    ProfileHandle m_profile;
+    Battery* m_battery;
+    InsulinCartridge* m_cartridge;
+    IOB* m_iob;
+    CGMSensor* m_sensor;
+    ControlIQ m_controlIQ;
+    std::int64_t m_doseRemainder;   // uU x ms owed, below one micro-unit
+    double m_pendingDischarge;  // hours of battery use not yet discharged
+};
+
+#endif // BASALENGINE_H
@@ -1,118 +1,123 @@
 #include "basalmanager.h"
+#include "deliverythread.h"
+#include "handlertiming.h"
+#include "logger.h"
+#include "alloccounter.h"
+#include <algorithm>
 
-BasalManager::BasalManager(Profile* profile, Battery* battery, InsulinCartridge* cartridge, IOB* iob, CGMSensor* sensor, QObject* parent)
+BasalManager::BasalManager(ProfileManager* profileManager, ProfileHandle profile, Battery* battery, InsulinCartridge* cartridge, IOB* iob, CGMSensor* sensor, DataManager* dataManager, DeliveryThread* delivery, QObject* parent)
     : QObject(parent),
-    m_profile(profile),
-    m_battery(battery),
-    m_cartridge(cartridge),
-    m_iob(iob),
-    m_sensor(sensor),
+    m_engine(profileManager, profile, battery, cartridge, iob, sensor),
+    m_dataManager(dataManager),
+    m_delivery(delivery),
     m_timer(nullptr),
-    m_isPaused(false)
+    m_watchId(-1),
+    m_isPaused(false),
+    m_lastRate(0.0f),
+    m_intervalMs(SimClock::kTickRealMs),
+    m_jitterTicks(0),
+    m_shownRate(-1.0f),
+    m_tickAllocations(0)
 {}
 
 void BasalManager::startBasalDelivery(std::function<void(const QString&)> logCallback,
                                       std::function<void()> updateStatusCallback,
                                       std::function<void(const QString&)> basalStatusCallback)
 {
-    if (!m_profile) {
+    PUMP_TIME_HANDLER("BasalManager::startBasalDelivery");
+    switch (m_engine.canStart()) {
+    case BasalStatus::NoProfile:
         logCallback("[BASAL EVENT] No profile loaded.");
         return;
-    }
-    if (m_battery && m_battery->getStatus() == 0) {
+    case BasalStatus::BatteryDrained:
         logCallback("Battery is drained -> Charge the pump.");
         return;
-    }
-    float rate = m_profile->getBasalRate();
-    if (rate <= 0.0f) {
+    case BasalStatus::InvalidRate:
         logCallback("[BASAL] Set a valid basal rate in the profile to start delivery.");
         return;
+    default:
+        break;
     }
 
-    logCallback(QString("[BASAL] Basal Delivery started at %1 u/hr").arg(rate));
+    logCallback(QString("[BASAL] Basal Delivery started at %1 u/hr").arg(m_engine.profileRate()));
     m_timer = new QTimer(this);
-    ControlIQ controlIQ;
-
-    connect(m_timer, &QTimer::timeout, this, [=]() mutable {
-        // Battery Check
-
-        if (m_battery && m_battery->getStatus() <= 20) {
-            logCallback("[SYSTEM] 🪫 Low Battery ->  Battery is low -> Deliverying final doses.");
-        }
-
-
-        if (m_battery && m_battery->getStatus() == 0) {
+    m_timer->setTimerType(Qt::PreciseTimer);
+
+    connect(m_timer, &QTimer::timeout, this, [=]() {
+        PUMP_TIME_HANDLER("BasalManager::basalTick");
+        AllocationScope allocations;
+        m_delivery->watchdog().heartbeat(m_watchId);
+        BasalTickResult result = m_engine.tick(elapsedSimMs());
+        BasalEngine::logTick(result);
+
+        switch (result.status) {
+        case BasalStatus::Delivered:
+            break;
+        case BasalStatus::NoProfile:
+            logCallback("[BASAL] Profile removed -> Basal delivery paused.");
+            pause();
+            basalStatusCallback("Basal Paused (No Profile)");
+            return;
+        case BasalStatus::BatteryDrained:
             logCallback("Battery fully drained -> Basal Delivery paused.");
-            basalStatusCallback("Basal Paused (Battery 0%)");
             pause();
+            basalStatusCallback("Basal Paused (Battery 0%)");
             return;
-        }
-
-
-        // CGM Disconnection / Occlusion
-        if (m_sensor && !m_sensor->isConnected()) {
+        case BasalStatus::CgmDisconnected:
             logCallback("[SYSTEM] 🚫 CGM disconnected. Basal delivery paused.");
-            basalStatusCallback("Basal Paused (CGM Disconnected)");
             pause();
+            basalStatusCallback("Basal Paused (CGM Disconnected)");
             return;
-        }
-        if (m_cartridge && m_cartridge->isOccluded()) {
+        case BasalStatus::Occluded:
             logCallback("[SYSTEM] ❌ Occlusion detected. Basal delivery paused.");
-            basalStatusCallback("Basal Paused (Occlusion)");
             pause();
+            basalStatusCallback("Basal Paused (Occlusion)");
             return;
-        }
-
-        float cgm = m_sensor->getGlucoseLevel();
-        double adjustment = controlIQ.adjustDelivery(cgm);
-        float adjustedRate = rate * adjustment;
-
-        if (cgm < 4.0f) {
+        case BasalStatus::LowGlucose:
+        case BasalStatus::InvalidRate:
+            pause();
             basalStatusCallback("Basal Paused (Low CGM)");
             logCallback("[BASAL] Basal Delivery Paused — CGM too low (< 4.0 mmol/L)");
-            pause();
             return;
         }
 
-        // Insulin Delivery Logic
-        if (m_cartridge && m_cartridge->getInsulinLevel() > 0) {
-            int insulinLeft = m_cartridge->getInsulinLevel() - adjustedRate;
-            m_cartridge->updateInsulinLevel(insulinLeft > 0 ? insulinLeft : 0);
-        }
-
-        if (m_iob)
-            m_iob->updateIOB(m_iob->getIOB() + adjustedRate);
-
-        if (m_battery)
-            m_battery->discharge();
-
-        if (m_sensor) {
-            float newCGM = m_sensor->getGlucoseLevel() - 0.1f;
-            if (newCGM < 2.5f) newCGM = 2.5f;
-            m_sensor->updateGlucoseData(newCGM);
-        }
+        // The usage sample goes through a fixed ring, the log line is
+        // formatted into the Logger's slot and the status text is only
+        // rebuilt when the rate changes; the one allocation left is the
+        // GUI refresh DeliveryThread posts when none is pending
+        m_lastRate = result.rate;
+        if (m_dataManager)
+            m_delivery->recordBasal(BasalSample{result.delivered, result.glucose});
 
         updateStatusCallback();
-        basalStatusCallback(QString("Delivering Basal Insulin @ %1 u/hr").arg(adjustedRate));
-        logCallback(QString("[BASAL] Basal Delivered: %1 u | CGM: %2 mmol/L")
-                        .arg(adjustedRate, 0, 'f', 1)
-                        .arg(m_sensor->getGlucoseLevel(), 0, 'f', 1));
+        if (result.rate != m_shownRate) {
+            m_shownRate = result.rate;
+            basalStatusCallback(QString("Delivering Basal Insulin @ %1 u/hr").arg(result.rate));
+        }
+        m_tickAllocations = std::max<std::uint64_t>(m_tickAllocations, allocations.count());
     });
 
-    m_timer->start(10000);
+    m_shownRate = -1.0f;
+    m_timer->start(m_intervalMs);
+    m_sinceTick.start();
+    watch();
     m_isPaused = false;
 }
 
 void BasalManager::pause() {
     if (m_timer && m_timer->isActive()) {
         m_timer->stop();
+        unwatch();
         m_isPaused = true;
     }
 }
 
 void BasalManager::resume() {
     if (m_timer && m_isPaused) {
-        m_timer->start(10000);
+        m_timer->start(m_intervalMs);
+        m_sinceTick.restart();  // nothing is owed for the paused time
+        m_shownRate = -1.0f;    // the status still says paused
+        watch();
         m_isPaused = false;
     }
 }
@@ -120,6 +125,7 @@ void BasalManager::resume() {
 void BasalManager::stop() {
     if (m_timer) {
         m_timer->stop();
+        unwatch();
         m_timer->deleteLater();
         m_timer = nullptr;
     }
@@ -129,3 +135,57 @@ void BasalManager::stop() {
 bool BasalManager::isPaused() const {
     return m_isPaused;
 }
+
+BasalState BasalManager::state() const {
+    if (!m_timer)
+        return BasalState::Stopped;
+    return m_isPaused ? BasalState::Paused : BasalState::Running;
+}
+
+float BasalManager::lastRate() const {
+    return m_lastRate;
+}
+
+void BasalManager::setTickInterval(int ms) {
+    m_intervalMs = ms;
+    if (m_timer && m_timer->isActive())
+        m_timer->setInterval(ms);
+    m_delivery->watchdog().setDeadline(m_watchId, qint64(ms) * DeliveryWatchdog::kDefaultMissFactor);
+}
+
+const LatencyHistogram& BasalManager::tickJitter() const {
+    return m_jitter;
+}
+
+// Simulated time since the last tick, and how far it missed the period
+qint64 BasalManager::elapsedSimMs() {
+    qint64 elapsedNs = m_sinceTick.nsecsElapsed();
+    m_sinceTick.restart();
+
+    qint64 lateNs = elapsedNs - qint64(m_intervalMs) * 1000000;
+    m_jitter.record(static_cast<std::uint64_t>(lateNs < 0 ? -lateNs : lateNs));
+    if (++m_jitterTicks >= kJitterReportTicks) {
+        Logger::instance().logf(LogChannel::Console,
+                                "[BASAL] tick jitter over %d ticks: p50 %.2f ms, p99 %.2f ms, max %.2f ms",
+                                m_jitterTicks, m_jitter.percentile(0.5) / 1e6,
+                                m_jitter.percentile(0.99) / 1e6, m_jitter.max() / 1e6);
+        if (AllocationCounter::active())
+            Logger::instance().logf(LogChannel::Console, "[BASAL] heap allocations per tick: max %llu",
+                                    static_cast<unsigned long long>(m_tickAllocations));
+        m_jitter.reset();
+        m_jitterTicks = 0;
+        m_tickAllocations = 0;
+    }
+
+    elapsedNs = std::min(elapsedNs, kMaxCatchUpMs * 1000000);
+    return elapsedNs * SimClock::kSpeedup / 1000000;
+}
+
+void BasalManager::watch() {
+    m_watchId = m_delivery->watchdog().watch("basal", qint64(m_intervalMs) * DeliveryWatchdog::kDefaultMissFactor);
+}
+
+void BasalManager::unwatch() {
+    m_delivery->watchdog().release(m_watchId);
+    m_watchId = -1;
+}
@@ -3,23 +3,46 @@
 
 #include <QObject>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <functional>
 #include "src/models/profile.h"
+#include "src/models/profilemanager.h"
 #include "src/models/battery.h"
 #include "src/models/insulincartridge.h"
 #include "src/models/iob.h"
 #include "src/models/cgmsensor.h"
-#include "src/logic/controliq.h"
+#include "src/logic/basalengine.h"
+#include "src/logic/simclock.h"
+#include "src/logic/datamanager.h"
+#include "src/logic/pumpsnapshot.h"
+#include "src/logic/handlertiming.h"
+
+class DeliveryThread;
+
+//--------------------------------------------------------
+// BASAL MANAGER (lives on the delivery thread)
+// Drives BasalEngine from a precise QTimer, passing the
+// monotonic time since the last tick. Heartbeats the watchdog
+// and logs tick jitter (and allocations, when counted) once
+// per simulated day.
+//--------------------------------------------------------
 
 class BasalManager : public QObject {
     Q_OBJECT
 
 public:
-    BasalManager(Profile* profile,
+    static constexpr int kJitterReportTicks = 24;
+    // A longer gap (suspend, debugger) is not delivered all at once
+    static constexpr qint64 kMaxCatchUpMs = 6 * SimClock::kTickRealMs;
+
+    BasalManager(ProfileManager* profileManager,
+                 ProfileHandle profile,
                  Battery* battery,
                  InsulinCartridge* cartridge,
                  IOB* iob,
                  CGMSensor* sensor,
+                 DataManager* dataManager,
+                 DeliveryThread* delivery,
                  QObject* parent = nullptr);
 
     void startBasalDelivery(std::function<void(const QString&)> logCallback,
@@ -30,15 +53,30 @@ public:
     void resume();
     void stop();  // clean stop and reset
     bool isPaused() const;
+    BasalState state() const;
+    float lastRate() const;
+    // Timer period; the dose does not depend on it
+    void setTickInterval(int ms);
+    const LatencyHistogram& tickJitter() const;
 
 private:
-    Profile* m_profile;
-    Battery* m_battery;
-    InsulinCartridge* m_cartridge;
-    IOB* m_iob;
-    CGMSensor* m_sensor;
+    BasalEngine m_engine;  // resolves the profile handle every tick
+    DataManager* m_dataManager;
+    DeliveryThread* m_delivery;
     QTimer* m_timer;
+    int m_watchId;     // DeliveryWatchdog task while the timer runs
     bool m_isPaused;
+    float m_lastRate;
+    int m_intervalMs;
+    QElapsedTimer m_sinceTick;
+    LatencyHistogram m_jitter;
+    int m_jitterTicks;
+    float m_shownRate;                  // rate in the last status text
+    std::uint64_t m_tickAllocations;    // worst tick since the last report
+
+    qint64 elapsedSimMs();
+    void watch();
+    void unwatch();
 };
 
 #endif // BASALMANAGER_H
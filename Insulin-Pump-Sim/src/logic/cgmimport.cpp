@@ -0,0 +1,476 @@
+#include "cgmimport.h"
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+namespace {
+constexpr double kMgdlPerMmol = 18.0182;
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date
+std::int64_t daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const int yoe = year - era * 400;
+    const int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return static_cast<std::int64_t>(era) * 146097 + doe - 719468;
+}
+
+int digits(const char* text, int count) {
+    int value = 0;
+    for (int i = 0; i < count; i++) {
+        if (text[i] < '0' || text[i] > '9')
+            return -1;
+        value = value * 10 + (text[i] - '0');
+    }
+    return value;
+}
+
+std::int64_t toEpochMs(int year, int month, int day, int hour, int minute, int second) {
+    return ((daysFromCivil(year, month, day) * 24 + hour) * 60 + minute) * 60000LL + second * 1000LL;
+}
+
+// "2020-01-31T13:45:00(.123)(Z|+02:00)" or with a space instead of the T
+bool parseIsoTime(std::string_view text, std::int64_t& ms) {
+    if (text.size() < 19 || text[4] != '-' || text[7] != '-' || text[13] != ':' || text[16] != ':')
+        return false;
+    const char* s = text.data();
+    int year = digits(s, 4), month = digits(s + 5, 2), day = digits(s + 8, 2);
+    int hour = digits(s + 11, 2), minute = digits(s + 14, 2), second = digits(s + 17, 2);
+    if (year < 0 || month < 1 || month > 12 || day < 1 || hour < 0 || minute < 0 || second < 0)
+        return false;
+    ms = toEpochMs(year, month, day, hour, minute, second);
+
+    std::size_t i = 19;
+    if (i < text.size() && text[i] == '.') {
+        int scale = 100;
+        for (i++; i < text.size() && text[i] >= '0' && text[i] <= '9'; i++, scale /= 10)
+            ms += (text[i] - '0') * scale;
+    }
+    if (i + 6 <= text.size() && (text[i] == '+' || text[i] == '-')) {
+        int offsetHours = digits(s + i + 1, 2), offsetMinutes = digits(s + i + 4, 2);
+        if (offsetHours >= 0 && offsetMinutes >= 0) {
+            std::int64_t offset = (offsetHours * 60 + offsetMinutes) * 60000LL;
+            ms += text[i] == '+' ? -offset : offset;
+        }
+    }
+    return true;
+}
+
+// OhioT1DM: "21-09-2027 10:51:00" (day first)
+bool parseOhioTime(std::string_view text, std::int64_t& ms) {
+    if (text.size() < 19 || text[2] != '-' || text[5] != '-' || text[13] != ':' || text[16] != ':')
+        return parseIsoTime(text, ms);
+    const char* s = text.data();
+    int day = digits(s, 2), month = digits(s + 3, 2), year = digits(s + 6, 4);
+    int hour = digits(s + 11, 2), minute = digits(s + 14, 2), second = digits(s + 17, 2);
+    if (year < 0 || month < 1 || month > 12 || day < 1 || hour < 0 || minute < 0 || second < 0)
+        return false;
+    ms = toEpochMs(year, month, day, hour, minute, second);
+    return true;
+}
+
+// Number token -> double; integers skip strtod
+bool parseNumber(const char* text, std::size_t length, double& value) {
+    if (length == 0 || length > 63)
+        return false;
+    std::size_t i = text[0] == '-' ? 1 : 0;
+    std::int64_t whole = 0;
+    std::size_t start = i;
+    for (; i < length && text[i] >= '0' && text[i] <= '9'; i++)
+        whole = whole * 10 + (text[i] - '0');
+    if (i == length && i > start) {
+        value = static_cast<double>(text[0] == '-' ? -whole : whole);
+        return true;
+    }
+    char copy[64];
+    std::memcpy(copy, text, length);
+    copy[length] = '\0';
+    char* end = nullptr;
+    value = std::strtod(copy, &end);
+    return end == copy + length;
+}
+
+// value of name="..." inside an XML tag
+std::string_view attribute(std::string_view tag, std::string_view name) {
+    std::size_t at = 0;
+    while ((at = tag.find(name, at)) != std::string_view::npos) {
+        std::size_t quote = at + name.size();
+        bool boundary = at == 0 || isSpace(tag[at - 1]);
+        if (boundary && quote + 1 < tag.size() && tag[quote] == '=' && tag[quote + 1] == '"') {
+            std::size_t close = tag.find('"', quote + 2);
+            if (close == std::string_view::npos)
+                return std::string_view();
+            return tag.substr(quote + 2, close - quote - 2);
+        }
+        at = quote;
+    }
+    return std::string_view();
+}
+}
+
+CgmImportReader::CgmImportReader()
+    : m_file(nullptr),
+    m_begin(0),
+    m_end(0),
+    m_eof(true),
+    m_format(CgmFileFormat::Unknown),
+    m_bytesRead(0),
+    m_readings(0),
+    m_skipped(0),
+    m_inGlucose(false),
+    m_depth(0)
+{}
+
+CgmImportReader::~CgmImportReader() {
+    close();
+}
+
+bool CgmImportReader::open(const std::string& path) {
+    close();
+    m_file = std::fopen(path.c_str(), "rb");
+    if (!m_file)
+        return false;
+    m_buffer.resize(kChunkBytes);
+    m_begin = m_end = 0;
+    m_eof = false;
+    m_bytesRead = m_readings = m_skipped = 0;
+    m_inGlucose = false;
+    m_depth = 0;
+
+    // Sniff the first non-blank byte (after a UTF-8 BOM)
+    m_format = CgmFileFormat::Unknown;
+    while (m_format == CgmFileFormat::Unknown) {
+        if (m_begin == m_end && !fill())
+            break;
+        char c = m_buffer[m_begin];
+        if (isSpace(c) || c == '\xEF' || c == '\xBB' || c == '\xBF') {
+            m_begin++;
+            continue;
+        }
+        if (c == '<')
+            m_format = CgmFileFormat::OhioXml;
+        else if (c == '[' || c == '{')
+            m_format = CgmFileFormat::Json;
+        else
+            m_format = CgmFileFormat::Csv;
+    }
+    return m_format != CgmFileFormat::Unknown;
+}
+
+void CgmImportReader::close() {
+    if (m_file)
+        std::fclose(m_file);
+    m_file = nullptr;
+    m_eof = true;
+    m_begin = m_end = 0;
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+}
+
+bool CgmImportReader::next(CgmReading& reading) {
+    bool found = false;
+    switch (m_format) {
+    case CgmFileFormat::Csv:     found = nextCsv(reading); break;
+    case CgmFileFormat::OhioXml: found = nextXml(reading); break;
+    case CgmFileFormat::Json:    found = nextJson(reading); break;
+    case CgmFileFormat::Unknown: break;
+    }
+    if (found) {
+        reading.sequence = 0;
+        m_readings++;
+    }
+    return found;
+}
+
+CgmFileFormat CgmImportReader::format() const {
+    return m_format;
+}
+
+std::uint64_t CgmImportReader::bytesRead() const {
+    return m_bytesRead;
+}
+
+std::uint64_t CgmImportReader::readings() const {
+    return m_readings;
+}
+
+std::uint64_t CgmImportReader::skipped() const {
+    return m_skipped;
+}
+
+// Keep the unparsed tail, read the next chunk after it. A unit
+// longer than the buffer doubles it.
+bool CgmImportReader::fill() {
+    if (m_eof)
+        return false;
+    std::size_t keep = m_end - m_begin;
+    if (keep == m_buffer.size())
+        m_buffer.resize(m_buffer.size() * 2);
+    if (m_begin > 0 && keep > 0)
+        std::memmove(m_buffer.data(), m_buffer.data() + m_begin, keep);
+    m_begin = 0;
+    m_end = keep;
+    std::size_t read = std::fread(m_buffer.data() + m_end, 1, m_buffer.size() - m_end, m_file);
+    if (read == 0) {
+        m_eof = true;
+        return false;
+    }
+    m_end += read;
+    m_bytesRead += read;
+    return true;
+}
+
+bool CgmImportReader::nextCsv(CgmReading& reading) {
+    for (;;) {
+        const char* start = m_buffer.data() + m_begin;
+        const char* newline = static_cast<const char*>(std::memchr(start, '\n', m_end - m_begin));
+        if (!newline && fill())
+            continue;
+        if (!newline && m_begin == m_end)
+            return false;
+        std::size_t length = newline ? static_cast<std::size_t>(newline - start) : m_end - m_begin;
+        m_begin += newline ? length + 1 : length;
+
+        std::string_view line(start, length);
+        if (line.empty() || line[0] == '#' || line[0] == '\r')
+            continue;
+        std::size_t comma = line.find(',');
+        double timestamp = 0.0, mmol = 0.0;
+        std::size_t valueEnd = line.find_first_of(",\r", comma + 1);
+        if (comma == std::string_view::npos
+            || !parseNumber(start, comma, timestamp)
+            || !parseNumber(start + comma + 1, (valueEnd == std::string_view::npos ? length : valueEnd) - comma - 1, mmol)) {
+            m_skipped++;
+            continue;
+        }
+        reading.timestampMs = static_cast<std::int64_t>(timestamp);
+        reading.mmol = static_cast<float>(mmol);
+        return true;
+    }
+}
+
+bool CgmImportReader::nextXml(CgmReading& reading) {
+    for (;;) {
+        const char* base = m_buffer.data();
+        const char* open = static_cast<const char*>(std::memchr(base + m_begin, '<', m_end - m_begin));
+        if (!open) {
+            m_begin = m_end;
+            if (!fill())
+                return false;
+            continue;
+        }
+        m_begin = static_cast<std::size_t>(open - base);
+        const char* close = static_cast<const char*>(std::memchr(open, '>', m_end - m_begin));
+        if (!close) {
+            if (!fill())
+                return false;
+            continue;
+        }
+        std::string_view tag(open + 1, static_cast<std::size_t>(close - open - 1));
+        m_begin = static_cast<std::size_t>(close - base) + 1;
+
+        if (tag.compare(0, 13, "glucose_level") == 0) {
+            m_inGlucose = tag.back() != '/';
+        } else if (tag.compare(0, 14, "/glucose_level") == 0) {
+            m_inGlucose = false;
+        } else if (m_inGlucose && tag.compare(0, 6, "event ") == 0) {
+            std::string_view ts = attribute(tag, "ts");
+            std::string_view value = attribute(tag, "value");
+            double mgdl = 0.0;
+            std::int64_t timeMs = 0;
+            if (!parseOhioTime(ts, timeMs) || !parseNumber(value.data(), value.size(), mgdl) || mgdl <= 0.0) {
+                m_skipped++;
+                continue;
+            }
+            reading.timestampMs = timeMs;
+            reading.mmol = static_cast<float>(mgdl / kMgdlPerMmol);
+            return true;
+        }
+    }
+}
+
+bool CgmImportReader::nextJson(CgmReading& reading) {
+    for (;;) {
+        while (m_begin < m_end && isSpace(m_buffer[m_begin]))
+            m_begin++;
+        if (m_begin == m_end) {
+            if (!fill())
+                return false;
+            continue;
+        }
+        const char* base = m_buffer.data();
+        char c = base[m_begin];
+        switch (c) {
+        case '{':
+        case '[':
+            m_begin++;
+            jsonOpen(c == '{');
+            continue;
+        case '}':
+        case ']':
+            m_begin++;
+            if (jsonClose(reading))
+                return true;
+            continue;
+        case ':':
+            m_begin++;
+            if (JsonLevel* level = jsonTop())
+                level->expectKey = false;
+            continue;
+        case ',':
+            m_begin++;
+            if (JsonLevel* level = jsonTop())
+                level->expectKey = level->object;
+            continue;
+        case '"': {
+            // Closing quote = one not preceded by an odd run of backslashes
+            std::size_t at = m_begin + 1;
+            const char* quote = nullptr;
+            while (at < m_end) {
+                quote = static_cast<const char*>(std::memchr(base + at, '"', m_end - at));
+                if (!quote)
+                    break;
+                std::size_t backslashes = 0;
+                while (quote - backslashes - 1 > base + m_begin && quote[-1 - static_cast<std::ptrdiff_t>(backslashes)] == '\\')
+                    backslashes++;
+                if (backslashes % 2 == 0)
+                    break;
+                at = static_cast<std::size_t>(quote - base) + 1;
+                quote = nullptr;
+            }
+            if (!quote) {
+                if (!fill())
+                    return false;
+                continue;
+            }
+            const char* text = base + m_begin + 1;
+            m_begin = static_cast<std::size_t>(quote - base) + 1;
+            jsonString(text, static_cast<std::size_t>(quote - text));
+            continue;
+        }
+        default: {
+            std::size_t end = m_begin;
+            while (end < m_end && base[end] != ',' && base[end] != '}' && base[end] != ']' && !isSpace(base[end]))
+                end++;
+            if (end == m_end && !m_eof) {
+                fill();
+                continue;
+            }
+            jsonScalar(base + m_begin, end - m_begin);
+            m_begin = end;
+            continue;
+        }
+        }
+    }
+}
+
+CgmImportReader::JsonLevel* CgmImportReader::jsonTop() {
+    if (m_depth == 0 || m_depth > kMaxJsonDepth)
+        return nullptr;
+    return &m_levels[m_depth - 1];
+}
+
+void CgmImportReader::jsonOpen(bool object) {
+    m_depth++;
+    if (JsonLevel* level = jsonTop()) {
+        *level = JsonLevel{};
+        level->object = object;
+        level->expectKey = object;
+    }
+}
+
+bool CgmImportReader::jsonClose(CgmReading& reading) {
+    JsonLevel* level = jsonTop();
+    if (m_depth > 0)
+        m_depth--;
+    if (!level || !level->object)
+        return false;
+    if (!level->hasValue && !level->hasTime && !level->wrongType)
+        return false;   // a nested object that is not a record
+    if (!level->hasValue || !level->hasTime || level->wrongType || level->value <= 0.0) {
+        m_skipped++;
+        return false;
+    }
+    reading.timestampMs = level->timeMs;
+    reading.mmol = static_cast<float>(level->mgdl ? level->value / kMgdlPerMmol : level->value);
+    return true;
+}
+
+void CgmImportReader::jsonString(const char* text, std::size_t length) {
+    JsonLevel* level = jsonTop();
+    if (!level || !level->object)
+        return;
+    std::string_view value(text, length);
+    if (level->expectKey) {
+        if (value == "sgv")
+            level->key = JsonKey::Sgv;
+        else if (value == "value")
+            level->key = JsonKey::Value;
+        else if (value == "units")
+            level->key = JsonKey::Units;
+        else if (value == "type")
+            level->key = JsonKey::Type;
+        else if (value == "date")
+            level->key = JsonKey::Date;
+        else if (value == "dateString" || value == "time" || value == "sysTime")
+            level->key = JsonKey::DateString;
+        else
+            level->key = JsonKey::Other;
+        return;
+    }
+    switch (level->key) {
+    case JsonKey::Units:
+        level->mgdl = value == "mg/dL" || value == "mg/dl";
+        break;
+    case JsonKey::Type:
+        level->wrongType = value != "sgv" && value != "cbg";
+        break;
+    case JsonKey::DateString:
+        if (!level->epochTime && parseIsoTime(value, level->timeMs))
+            level->hasTime = true;
+        break;
+    case JsonKey::Sgv:
+    case JsonKey::Value:
+        // Some exports quote their numbers
+        jsonScalar(text, length);
+        break;
+    default:
+        break;
+    }
+}
+
+void CgmImportReader::jsonScalar(const char* text, std::size_t length) {
+    JsonLevel* level = jsonTop();
+    if (!level || !level->object || level->expectKey)
+        return;
+    double number = 0.0;
+    switch (level->key) {
+    case JsonKey::Sgv:
+        if (parseNumber(text, length, number)) {
+            level->value = number;
+            level->mgdl = true;
+            level->hasValue = true;
+        }
+        break;
+    case JsonKey::Value:
+        if (!level->hasValue && parseNumber(text, length, number)) {
+            level->value = number;
+            level->hasValue = true;
+        }
+        break;
+    case JsonKey::Date:
+        if (parseNumber(text, length, number)) {
+            level->timeMs = static_cast<std::int64_t>(number);
+            level->hasTime = true;
+            level->epochTime = true;
+        }
+        break;
+    default:
+        break;
+    }
+}
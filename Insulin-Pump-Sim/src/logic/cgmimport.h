@@ -0,0 +1,99 @@
+#ifndef CGMIMPORT_H
+#define CGMIMPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "cgmingest.h"
+
+enum class CgmFileFormat {
+    Unknown,
+    Csv,            // "timestamp_ms,mmol" lines
+    OhioXml,        // OhioT1DM <glucose_level><event ts=".." value=".."/>
+    Json            // Nightscout entries / Tidepool cbg records
+};
+
+//--------------------------------------------------------
+// CGM IMPORT READER (streaming dataset parser)
+// Pulls readings one at a time out of a file read in 1 MB
+// chunks, so memory stays flat however big the file is. The
+// format is sniffed from the first byte. XML is scanned tag by
+// tag and only <event>s inside <glucose_level> count. JSON is
+// tokenized incrementally; any object carrying a glucose value
+// (sgv, or value with units) and a time (date, dateString,
+// time or sysTime) becomes a reading, and records typed as
+// something other than sgv / cbg are skipped. mg/dL values
+// are converted to mmol/L; times become epoch milliseconds.
+//--------------------------------------------------------
+class CgmImportReader {
+public:
+    static constexpr std::size_t kChunkBytes = 1 << 20;
+
+    CgmImportReader();
+    ~CgmImportReader();
+
+    bool open(const std::string& path);
+    void close();
+
+    // Next reading in file order (not sorted; see TraceCache); false at the end
+    bool next(CgmReading& reading);
+
+    CgmFileFormat format() const;
+    std::uint64_t bytesRead() const;
+    std::uint64_t readings() const;
+    std::uint64_t skipped() const;     // records that were not usable CGM readings
+
+private:
+    static constexpr int kMaxJsonDepth = 32;
+
+    enum class JsonKey {
+        Other,
+        Sgv,
+        Value,
+        Units,
+        Type,
+        Date,
+        DateString
+    };
+
+    struct JsonLevel {
+        bool object;
+        bool expectKey;
+        JsonKey key;
+        bool hasValue;
+        bool mgdl;
+        bool hasTime;
+        bool epochTime;     // "date" wins over the ISO strings
+        bool wrongType;
+        double value;
+        std::int64_t timeMs;
+    };
+
+    bool fill();
+    bool nextCsv(CgmReading& reading);
+    bool nextXml(CgmReading& reading);
+    bool nextJson(CgmReading& reading);
+    void jsonOpen(bool object);
+    bool jsonClose(CgmReading& reading);
+    void jsonString(const char* text, std::size_t length);
+    void jsonScalar(const char* text, std::size_t length);
+    JsonLevel* jsonTop();
+
+    std::FILE* m_file;
+    std::vector<char> m_buffer;
+    std::size_t m_begin;        // first unparsed byte
+    std::size_t m_end;          // end of valid data
+    bool m_eof;
+    CgmFileFormat m_format;
+    std::uint64_t m_bytesRead;
+    std::uint64_t m_readings;
+    std::uint64_t m_skipped;
+
+    bool m_inGlucose;           // XML: inside <glucose_level>
+    int m_depth;                // JSON nesting, may exceed kMaxJsonDepth
+    JsonLevel m_levels[kMaxJsonDepth];
+};
+
+#endif // CGMIMPORT_H
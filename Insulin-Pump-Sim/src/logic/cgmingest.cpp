@@ -0,0 +1,157 @@
+#include "cgmingest.h"
+#include "cgmimport.h"
+#include "tracecache.h"
+#include "eventtrace.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+CgmIngest::CgmIngest()
+    : m_nextSequence(0),
+    m_stopping(false),
+    m_held(kBackfillCapacity),
+    m_expectedSequence(0),
+    m_haveSequence(false),
+    m_produced(0),
+    m_overruns(0),
+    m_consumed(0),
+    m_gaps(0),
+    m_backfilled(0),
+    m_backfillDropped(0)
+{}
+
+CgmIngest::~CgmIngest() {
+    stopProducer();
+}
+
+void CgmIngest::startProducer(Source source, std::int64_t periodMs) {
+    stopProducer();
+    m_stopping = false;
+    m_producer = std::thread([this, source, periodMs]() { run(source, periodMs); });
+}
+
+void CgmIngest::stopProducer() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    if (m_producer.joinable())
+        m_producer.join();
+}
+
+bool CgmIngest::push(CgmReading reading) {
+    reading.sequence = m_nextSequence++;
+    m_produced.fetch_add(1, std::memory_order_relaxed);
+    if (!m_ring.tryPush(reading)) {
+        m_overruns.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void CgmIngest::consume(CGMSensor& sensor, Batch& batch) {
+    bool connected = sensor.isConnected();
+    CgmReading reading;
+    while (m_ring.tryPop(reading)) {
+        m_consumed.fetch_add(1, std::memory_order_relaxed);
+        if (m_haveSequence && reading.sequence != m_expectedSequence)
+            m_gaps.fetch_add(reading.sequence - m_expectedSequence, std::memory_order_relaxed);
+        m_expectedSequence = reading.sequence + 1;
+        m_haveSequence = true;
+
+        if (connected) {
+            batch.live.push_back(reading);
+        } else {
+            if (m_held.full())
+                m_backfillDropped.fetch_add(1, std::memory_order_relaxed);
+            m_held.push(reading);
+        }
+    }
+    if (!connected)
+        return;
+
+    // Back in range: hand over what was missed, oldest first
+    if (!m_held.empty()) {
+        for (std::size_t i = 0; i < m_held.size(); i++)
+            batch.backfill.push_back(m_held.at(i));
+        m_backfilled.fetch_add(m_held.size(), std::memory_order_relaxed);
+        m_held.clear();
+    }
+    if (!batch.empty())
+        PUMP_TRACE_INSTANT("CGM update");
+    if (!batch.live.empty())
+        sensor.updateGlucoseData(batch.live.back().mmol);
+    else if (!batch.backfill.empty())
+        sensor.updateGlucoseData(batch.backfill.back().mmol);
+}
+
+CgmIngest::Stats CgmIngest::stats() const {
+    return Stats{m_produced.load(std::memory_order_relaxed),
+                 m_overruns.load(std::memory_order_relaxed),
+                 m_consumed.load(std::memory_order_relaxed),
+                 m_gaps.load(std::memory_order_relaxed),
+                 m_backfilled.load(std::memory_order_relaxed),
+                 m_backfillDropped.load(std::memory_order_relaxed)};
+}
+
+CgmIngest::Source CgmIngest::synthetic(float base, float amplitude, std::int64_t cycleMs, std::int64_t stepMs) {
+    std::int64_t now = 0;
+    return [=](CgmReading& reading) mutable {
+        double phase = 2.0 * 3.14159265358979 * static_cast<double>(now % cycleMs) / cycleMs;
+        reading.timestampMs = now;
+        reading.mmol = base + amplitude * static_cast<float>(std::sin(phase));
+        now += stepMs;
+        return true;
+    };
+}
+
+CgmIngest::Source CgmIngest::replay(const std::string& path) {
+    auto trace = std::make_shared<TraceCache>();
+    if (trace->load(path)) {
+        std::size_t next = 0;
+        return [trace, next](CgmReading& reading) mutable {
+            if (next >= trace->rows())
+                return false;
+            reading.timestampMs = trace->timestamps()[next];
+            reading.mmol = trace->glucose()[next];
+            next++;
+            return true;
+        };
+    }
+    // No cache (read-only directory, no mmap): parse it all up
+    // front, since files may list readings newest first
+    auto readings = std::make_shared<std::vector<CgmReading>>();
+    CgmImportReader reader;
+    if (reader.open(path)) {
+        CgmReading reading{};
+        while (reader.next(reading))
+            readings->push_back(reading);
+    }
+    std::stable_sort(readings->begin(), readings->end(), [](const CgmReading& a, const CgmReading& b) {
+        return a.timestampMs < b.timestampMs;
+    });
+    std::size_t next = 0;
+    return [readings, next](CgmReading& reading) mutable {
+        if (next >= readings->size())
+            return false;
+        reading = (*readings)[next++];
+        return true;
+    };
+}
+
+void CgmIngest::run(Source source, std::int64_t periodMs) {
+    PUMP_TRACE_THREAD("cgm producer");
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        lock.unlock();
+        CgmReading reading{};
+        if (!source(reading))
+            return;
+        push(reading);
+        lock.lock();
+        m_wake.wait_for(lock, std::chrono::milliseconds(periodMs), [this]() { return m_stopping; });
+    }
+}
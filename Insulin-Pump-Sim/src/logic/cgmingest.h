@@ -0,0 +1,99 @@
+#ifndef CGMINGEST_H
+#define CGMINGEST_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "src/models/cgmsensor.h"
+#include "ringbuffer.h"
+#include "spscring.h"
+
+struct CgmReading {
+    std::int64_t timestampMs;   // sensor time
+    float mmol;
+    std::uint32_t sequence;     // assigned on push; a jump means readings were lost
+};
+
+//--------------------------------------------------------
+// CGM INGEST (sensor readings -> delivery loop)
+// A producer (file replay, synthetic generator, or any one
+// external feed) pushes readings into a lock-free SPSC ring;
+// the delivery loop drains it at its own pace with consume().
+// A full ring drops the new reading and counts an overrun.
+// Readings drained while the sensor is disconnected are held
+// (up to a day's worth) and handed back as backfill once it
+// reconnects; the newest reading becomes the sensor value.
+//--------------------------------------------------------
+class CgmIngest {
+public:
+    static constexpr std::size_t kRingCapacity = 256;
+    static constexpr std::size_t kBackfillCapacity = 288;   // 24 h of 5-minute readings
+
+    // Fills the next reading; false when the source is exhausted
+    using Source = std::function<bool(CgmReading& reading)>;
+
+    struct Batch {
+        std::vector<CgmReading> live;
+        std::vector<CgmReading> backfill;   // oldest first
+        bool empty() const { return live.empty() && backfill.empty(); }
+    };
+
+    struct Stats {
+        std::uint64_t produced;
+        std::uint64_t overruns;         // ring full, reading dropped
+        std::uint64_t consumed;
+        std::uint64_t gaps;             // readings missing from the sequence
+        std::uint64_t backfilled;
+        std::uint64_t backfillDropped;  // held buffer full, oldest overwritten
+    };
+
+    CgmIngest();
+    ~CgmIngest();
+
+    // Producer thread: one reading from source every periodMs
+    void startProducer(Source source, std::int64_t periodMs);
+    void stopProducer();
+    // Single producer: the thread above, or an external feed when none runs
+    bool push(CgmReading reading);
+
+    // Consumer (delivery thread): drain the ring into the sensor
+    void consume(CGMSensor& sensor, Batch& batch);
+    Stats stats() const;
+
+    // Sine wave around base (mmol/L), one reading per stepMs of sensor time
+    static Source synthetic(float base, float amplitude, std::int64_t cycleMs, std::int64_t stepMs);
+    // Dataset file (CSV, OhioT1DM XML, Nightscout / Tidepool JSON), via its TraceCache;
+    // readings come out oldest first whatever order the file lists them in
+    static Source replay(const std::string& path);
+
+private:
+    void run(Source source, std::int64_t periodMs);
+
+    SpscRing<CgmReading, kRingCapacity> m_ring;
+
+    // Producer side
+    std::uint32_t m_nextSequence;
+    std::thread m_producer;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping;
+
+    // Consumer side
+    RingBuffer<CgmReading> m_held;
+    std::uint32_t m_expectedSequence;
+    bool m_haveSequence;
+
+    std::atomic<std::uint64_t> m_produced;
+    std::atomic<std::uint64_t> m_overruns;
+    std::atomic<std::uint64_t> m_consumed;
+    std::atomic<std::uint64_t> m_gaps;
+    std::atomic<std::uint64_t> m_backfilled;
+    std::atomic<std::uint64_t> m_backfillDropped;
+};
+
+#endif // CGMINGEST_H
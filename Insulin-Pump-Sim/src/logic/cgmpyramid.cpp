@@ -0,0 +1,168 @@
+#include "cgmpyramid.h"
+#include <algorithm>
+#include <cmath>
+
+CgmPyramid::CgmPyramid()
+    : m_raw(kQuantum), m_cutoffMs(0)
+{}
+
+std::int64_t CgmPyramid::bucketWidth(int level) {
+    std::int64_t width = kBaseBucketMs;
+    for (int i = 0; i < level; i++)
+        width *= kLevelFactor;
+    return width;
+}
+
+void CgmPyramid::add(std::int64_t timestampMs, float value) {
+    if (m_raw.size() > 0 && timestampMs < m_raw.lastTimestamp())
+        timestampMs = m_raw.lastTimestamp();
+    m_raw.append(timestampMs, value);
+
+    for (int level = 0; level < kLevels; level++) {
+        std::int64_t width = bucketWidth(level);
+        std::int64_t start = timestampMs - (timestampMs % width);
+        std::deque<Bucket>& buckets = m_levels[level];
+        if (!buckets.empty() && buckets.back().startMs == start) {
+            Bucket& b = buckets.back();
+            b.min = std::min(b.min, value);
+            b.max = std::max(b.max, value);
+            b.sum += value;
+            b.count++;
+        } else {
+            buckets.push_back({start, value, value, value, 1});
+        }
+    }
+    expire(timestampMs);
+}
+
+void CgmPyramid::expire(std::int64_t nowMs) {
+    std::int64_t cutoff = nowMs - kRetentionMs;
+    m_cutoffMs = std::max(m_cutoffMs, cutoff);
+    m_raw.dropBefore(cutoff);
+    for (int level = 0; level < kLevels; level++) {
+        std::int64_t width = bucketWidth(level);
+        std::deque<Bucket>& buckets = m_levels[level];
+        while (!buckets.empty() && buckets.front().startMs + width < cutoff)
+            buckets.pop_front();
+    }
+}
+
+std::size_t CgmPyramid::rawCount() const {
+    return m_raw.aggregate(m_cutoffMs, m_raw.lastTimestamp()).count;
+}
+
+std::size_t CgmPyramid::rawBytes() const {
+    return m_raw.compressedBytes();
+}
+
+std::int64_t CgmPyramid::firstTimestamp() const {
+    if (m_raw.size() == 0)
+        return 0;
+    std::int64_t first = 0;
+    bool found = false;
+    m_raw.scan(m_cutoffMs, m_raw.lastTimestamp(), [&](std::int64_t ts, double) {
+        if (!found) {
+            first = ts;
+            found = true;
+        }
+    });
+    return first;
+}
+
+std::int64_t CgmPyramid::lastTimestamp() const {
+    return m_raw.lastTimestamp();
+}
+
+PyramidView CgmPyramid::query(std::int64_t fromMs, std::int64_t toMs, std::size_t maxPoints) const {
+    PyramidView view;
+    if (maxPoints < 3)
+        maxPoints = 3;
+
+    fromMs = std::max(fromMs, m_cutoffMs);
+    // Block summaries answer the count without decoding the middle of the range
+    std::size_t rawInRange = fromMs <= toMs ? m_raw.aggregate(fromMs, toMs).count : 0;
+
+    if (rawInRange <= maxPoints * kLttbFactor) {
+        std::vector<PyramidPoint> range;
+        range.reserve(rawInRange);
+        m_raw.scan(fromMs, toMs, [&range](std::int64_t ts, double v) {
+            range.push_back({ts, static_cast<float>(v)});
+        });
+        if (rawInRange <= maxPoints) {
+            view.raw = true;
+            view.line.swap(range);
+            return view;
+        }
+        // Fine zoom: keep the shape of the real samples
+        lttb(range.data(), range.data() + range.size(), maxPoints, view.line);
+        return view;
+    }
+
+    // Coarse zoom: finest level that fits the point budget
+    int level = kLevels - 1;
+    for (int l = 0; l < kLevels; l++) {
+        if (static_cast<std::size_t>((toMs - fromMs) / bucketWidth(l)) <= maxPoints) {
+            level = l;
+            break;
+        }
+    }
+    view.level = level;
+    std::int64_t half = bucketWidth(level) / 2;
+    const std::deque<Bucket>& buckets = m_levels[level];
+    auto b = std::lower_bound(buckets.begin(), buckets.end(), fromMs - bucketWidth(level),
+                              [](const Bucket& bk, std::int64_t t) { return bk.startMs < t; });
+    for (; b != buckets.end() && b->startMs <= toMs; ++b) {
+        std::int64_t mid = b->startMs + half;
+        view.line.push_back({mid, static_cast<float>(b->sum / b->count)});
+        view.low.push_back({mid, b->min});
+        view.high.push_back({mid, b->max});
+    }
+    return view;
+}
+
+void CgmPyramid::lttb(const PyramidPoint* begin, const PyramidPoint* end,
+                      std::size_t threshold, std::vector<PyramidPoint>& out) {
+    std::size_t n = static_cast<std::size_t>(end - begin);
+    out.clear();
+    if (threshold >= n || threshold < 3) {
+        out.assign(begin, end);
+        return;
+    }
+    out.reserve(threshold);
+    out.push_back(begin[0]);
+
+    double every = static_cast<double>(n - 2) / (threshold - 2);
+    std::size_t a = 0;
+    for (std::size_t i = 0; i < threshold - 2; i++) {
+        // Average of the next bucket is the third triangle vertex
+        std::size_t avgStart = static_cast<std::size_t>(std::floor((i + 1) * every)) + 1;
+        std::size_t avgEnd = std::min(static_cast<std::size_t>(std::floor((i + 2) * every)) + 1, n);
+        double avgX = 0.0;
+        double avgY = 0.0;
+        for (std::size_t j = avgStart; j < avgEnd; j++) {
+            avgX += static_cast<double>(begin[j].timestampMs);
+            avgY += begin[j].value;
+        }
+        std::size_t avgCount = avgEnd > avgStart ? avgEnd - avgStart : 1;
+        avgX /= avgCount;
+        avgY /= avgCount;
+
+        std::size_t rangeStart = static_cast<std::size_t>(std::floor(i * every)) + 1;
+        std::size_t rangeEnd = static_cast<std::size_t>(std::floor((i + 1) * every)) + 1;
+        double ax = static_cast<double>(begin[a].timestampMs);
+        double ay = begin[a].value;
+        double maxArea = -1.0;
+        std::size_t next = rangeStart;
+        for (std::size_t j = rangeStart; j < rangeEnd; j++) {
+            double area = std::fabs((ax - avgX) * (begin[j].value - ay)
+                                    - (ax - begin[j].timestampMs) * (avgY - ay));
+            if (area > maxArea) {
+                maxArea = area;
+                next = j;
+            }
+        }
+        out.push_back(begin[next]);
+        a = next;
+    }
+    out.push_back(begin[n - 1]);
+}
@@ -0,0 +1,75 @@
+#ifndef CGMPYRAMID_H
+#define CGMPYRAMID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "timeseriesstore.h"
+
+//--------------------------------------------------------
+// CGM PYRAMID (level-of-detail history for the zoomable chart)
+// Raw samples (a 0.1 mmol/L quantized TimeSeries, so the 90 days
+// stay compressed) plus levels of fixed-width min/max/mean buckets
+// (5 min, 20 min, 80 min, ... each 4x the previous). Every new
+// sample updates the last bucket of each level, so the pyramid
+// never needs a rebuild. query() answers from raw samples when
+// they fit, LTTB-downsampled raw samples at fine zoom, and the
+// coarsest-fitting bucket level further out.
+//--------------------------------------------------------
+struct PyramidPoint {
+    std::int64_t timestampMs;
+    float value;
+};
+
+struct PyramidView {
+    std::vector<PyramidPoint> line;  // mean / raw / LTTB values
+    std::vector<PyramidPoint> low;   // bucket minimums (empty for raw views)
+    std::vector<PyramidPoint> high;  // bucket maximums (empty for raw views)
+    bool raw = false;                // line holds untouched samples
+    int level = -1;                  // bucket level used, -1 for raw/LTTB
+};
+
+class CgmPyramid {
+public:
+    static constexpr std::int64_t kBaseBucketMs = 5 * 60 * 1000;
+    static constexpr int kLevels = 6;
+    static constexpr int kLevelFactor = 4;
+    static constexpr std::int64_t kRetentionMs = 90LL * 24 * 60 * 60 * 1000;
+    // LTTB is used while the raw range is at most this many times the budget
+    static constexpr std::size_t kLttbFactor = 8;
+    static constexpr double kQuantum = 0.1;
+
+    CgmPyramid();
+
+    void add(std::int64_t timestampMs, float value);
+    std::size_t rawCount() const;
+    std::size_t rawBytes() const;
+    std::int64_t firstTimestamp() const;
+    std::int64_t lastTimestamp() const;
+
+    PyramidView query(std::int64_t fromMs, std::int64_t toMs, std::size_t maxPoints) const;
+
+    static std::int64_t bucketWidth(int level);
+
+    // Largest-Triangle-Three-Buckets downsampling of [begin, end)
+    static void lttb(const PyramidPoint* begin, const PyramidPoint* end,
+                     std::size_t threshold, std::vector<PyramidPoint>& out);
+
+private:
+    struct Bucket {
+        std::int64_t startMs;
+        float min;
+        float max;
+        double sum;
+        std::uint32_t count;
+    };
+
+    void expire(std::int64_t nowMs);
+
+    TimeSeries m_raw;
+    std::int64_t m_cutoffMs;    // raw blocks are only dropped whole
+    std::deque<Bucket> m_levels[kLevels];
+};
+
+#endif // CGMPYRAMID_H
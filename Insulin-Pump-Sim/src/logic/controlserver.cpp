@@ -0,0 +1,143 @@
+#include "controlserver.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include "handlertiming.h"
+
+ControlServer::ControlServer(DeliveryThread* delivery, QObject* parent)
+    : QObject(parent),
+    m_delivery(delivery),
+    m_server(new QLocalServer(this))
+{
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(m_server, &QLocalServer::newConnection, this, &ControlServer::onConnection);
+}
+
+ControlServer::~ControlServer() {
+    m_server->close();
+}
+
+bool ControlServer::listen(const QString& name) {
+    if (m_server->listen(name))
+        return true;
+    if (m_server->serverError() != QAbstractSocket::AddressInUseError)
+        return false;
+    // A crashed run can leave a stale socket file behind; only clear it if nobody answers
+    QLocalSocket probe;
+    probe.connectToServer(name);
+    if (probe.waitForConnected(kProbeMs)) {
+        probe.disconnectFromServer();
+        return false;   // another instance owns the name
+    }
+    QLocalServer::removeServer(name);
+    return m_server->listen(name);
+}
+
+QString ControlServer::errorString() const {
+    return m_server->errorString();
+}
+
+void ControlServer::addCommand(const QString& name, Handler handler) {
+    m_commands.insert(name, handler);
+}
+
+void ControlServer::publishState() {
+    if (m_watchers.isEmpty())
+        return;
+    QByteArray line = stateLine();
+    for (QLocalSocket* client : m_watchers)
+        client->write(line);
+}
+
+void ControlServer::onConnection() {
+    while (QLocalSocket* client = m_server->nextPendingConnection()) {
+        connect(client, &QLocalSocket::readyRead, this, [this, client]() { onReadyRead(client); });
+        connect(client, &QLocalSocket::disconnected, this, [this, client]() { onDisconnected(client); });
+    }
+}
+
+void ControlServer::onReadyRead(QLocalSocket* client) {
+    PUMP_TIME_HANDLER("ControlServer::onReadyRead");
+    QByteArray& partial = m_partial[client];
+    partial.append(client->readAll());
+    int end = partial.lastIndexOf('\n');
+    // An unterminated line would otherwise grow without bound
+    if (partial.size() - (end + 1) > kMaxLineBytes) {
+        drop(client, "line too long");
+        return;
+    }
+    if (end < 0)
+        return;
+
+    // Whole batch in, whole batch out
+    QByteArray reply;
+    int start = 0;
+    while (start <= end) {
+        int newline = partial.indexOf('\n', start);
+        if (newline - start > kMaxLineBytes) {
+            client->write(reply);
+            drop(client, "line too long");
+            return;
+        }
+        QByteArray line = partial.mid(start, newline - start).trimmed();
+        start = newline + 1;
+        if (!line.isEmpty())
+            execute(client, line, reply);
+    }
+    partial.remove(0, end + 1);
+    if (!reply.isEmpty())
+        client->write(reply);
+}
+
+void ControlServer::onDisconnected(QLocalSocket* client) {
+    m_partial.remove(client);
+    m_watchers.remove(client);
+    client->deleteLater();
+}
+
+void ControlServer::drop(QLocalSocket* client, const char* reason) {
+    m_partial.remove(client);
+    m_watchers.remove(client);
+    disconnect(client, &QLocalSocket::readyRead, this, nullptr);
+    client->write(QByteArray("error ") + reason + '\n');
+    // Flushes the reply; disconnected() then deletes the socket
+    client->disconnectFromServer();
+}
+
+void ControlServer::execute(QLocalSocket* client, const QByteArray& line, QByteArray& reply) {
+    QStringList args = QString::fromUtf8(line).split(' ', Qt::SkipEmptyParts);
+    QString command = args.takeFirst();
+
+    if (command == "ping") {
+        reply.append("ok\n");
+    } else if (command == "state") {
+        reply.append(stateLine());
+    } else if (command == "watch") {
+        if (args.value(0) == "off")
+            m_watchers.remove(client);
+        else
+            m_watchers.insert(client);
+        reply.append("ok\n");
+    } else {
+        auto it = m_commands.constFind(command);
+        QString error = it == m_commands.constEnd() ? "unknown command " + command : it.value()(args);
+        if (error.isEmpty())
+            reply.append("ok\n");
+        else
+            reply.append("error " + error.toUtf8() + '\n');
+    }
+}
+
+QByteArray ControlServer::stateLine() const {
+    static const char* const kBasalStates[] = {"stopped", "running", "paused"};
+    PumpSnapshot state = m_delivery->snapshot();
+    return QString("state battery=%1 insulin=%2 iob=%3 glucose=%4 cgm=%5 occluded=%6 basal=%7 rate=%8\n")
+        .arg(state.battery)
+        .arg(state.insulin)
+        .arg(state.iob, 0, 'f', 2)
+        .arg(state.glucose, 0, 'f', 2)
+        .arg(state.cgmConnected ? 1 : 0)
+        .arg(state.occluded ? 1 : 0)
+        .arg(kBasalStates[static_cast<int>(state.basalState)])
+        .arg(state.basalRate, 0, 'f', 2)
+        .toUtf8();
+}
@@ -0,0 +1,62 @@
+#ifndef CONTROLSERVER_H
+#define CONTROLSERVER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include "deliverythread.h"
+
+class QLocalServer;
+class QLocalSocket;
+
+//--------------------------------------------------------
+// CONTROL SERVER (test automation over a local socket)
+// Newline-separated text commands, e.g. "bolus 2.5". A client
+// may pipeline any number of them: everything that has arrived
+// is run in order and answered with one write, one line per
+// command ("ok", "error <reason>" or "state ..."). Commands
+// are registered by name like navigation pages; "ping",
+// "state" and "watch on|off" are built in. Watching clients
+// get a state line after every published snapshot. Accepted
+// doses run on the delivery thread, so "state" shows them
+// once that thread has applied them. The socket is private
+// to the user, a live server of the same name is left alone,
+// and a client sending a line over kMaxLineBytes is dropped.
+//--------------------------------------------------------
+class ControlServer : public QObject {
+    Q_OBJECT
+public:
+    // Returns an error message, or an empty string on success
+    using Handler = std::function<QString(const QStringList& args)>;
+    static constexpr int kMaxLineBytes = 4096;
+    static constexpr int kProbeMs = 200;
+
+    ControlServer(DeliveryThread* delivery, QObject* parent = nullptr);
+    ~ControlServer();
+
+    bool listen(const QString& name);
+    QString errorString() const;
+    void addCommand(const QString& name, Handler handler);
+    // Stream the current snapshot to watching clients
+    void publishState();
+
+private:
+    void onConnection();
+    void onReadyRead(QLocalSocket* client);
+    void onDisconnected(QLocalSocket* client);
+    void drop(QLocalSocket* client, const char* reason);
+    void execute(QLocalSocket* client, const QByteArray& line, QByteArray& reply);
+    QByteArray stateLine() const;
+
+    DeliveryThread* m_delivery;
+    QLocalServer* m_server;
+    QHash<QString, Handler> m_commands;
+    QHash<QLocalSocket*, QByteArray> m_partial;   // bytes after the last newline
+    QSet<QLocalSocket*> m_watchers;
+};
+
+#endif // CONTROLSERVER_H
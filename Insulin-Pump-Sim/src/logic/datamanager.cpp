@@ -1,14 +1,153 @@
 #include "datamanager.h"
+#include "simclock.h"
+
+DataManager::DataManager() {
+    m_sinceStart.start();
+}
 
 void DataManager::logEvent(const QString& event) {
     QString timeStamped = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss") + " - " + event;
-    eventHistory.append(timeStamped);
+    append(timeStamped, categorize(event));
+    if (m_appendListener)
+        m_appendListener();
+}
+
+void DataManager::logFormattedEvent(const QString& line, EventCategory category) {
+    append(line, category);
+    if (m_appendListener)
+        m_appendListener();
+}
+
+void DataManager::logFormattedEvents(const QStringList& lines, const QVector<EventCategory>& categories) {
+    for (int i = 0; i < lines.size(); i++)
+        append(lines.at(i), i < categories.size() ? categories.at(i) : EventCategory::Other);
+    if (m_appendListener && !lines.isEmpty())
+        m_appendListener();
+}
+
+void DataManager::append(const QString& line, EventCategory category) {
+    m_categoryIndex[static_cast<int>(category)].append(eventHistory.size());
+    eventHistory.append(line);
+    m_categories.append(category);
 }
 
 QString DataManager::getHistory() const {
     return eventHistory.join("\n");
 }
 
+int DataManager::eventCount() const {
+    return eventHistory.size();
+}
+
+const QString& DataManager::eventAt(int index) const {
+    return eventHistory.at(index);
+}
+
+EventCategory DataManager::categoryAt(int index) const {
+    return m_categories.at(index);
+}
+
+const QVector<int>& DataManager::eventsInCategory(EventCategory category) const {
+    return m_categoryIndex[static_cast<int>(category)];
+}
+
+void DataManager::setAppendListener(std::function<void()> listener) {
+    m_appendListener = std::move(listener);
+}
+
+//sort a log message by its prefix
+EventCategory DataManager::categorize(const QString& event) {
+    if (event.startsWith("[BASAL"))
+        return EventCategory::Basal;
+    if (event.startsWith("[BOLUS") || event.startsWith("🍔") || event.startsWith("📈"))
+        return EventCategory::Bolus;
+    if (event.startsWith("[SYSTEM") || event.startsWith("[PUMP") || event.startsWith("[SLEEP MODE")
+        || event.startsWith("Simulated") || event.startsWith("Battery"))
+        return EventCategory::System;
+    if (event.startsWith("[PROFILE"))
+        return EventCategory::Profile;
+    if (event.startsWith("[ALERT") || event.startsWith("[SECURITY"))
+        return EventCategory::Settings;
+    return EventCategory::Other;
+}
+
+QString DataManager::categoryName(EventCategory category) {
+    switch (category) {
+    case EventCategory::Basal: return "Basal";
+    case EventCategory::Bolus: return "Bolus";
+    case EventCategory::System: return "System";
+    case EventCategory::Profile: return "Profile";
+    case EventCategory::Settings: return "Settings";
+    case EventCategory::Other: return "Other";
+    case EventCategory::Count: break;
+    }
+    return QString();
+}
+
+void DataManager::recordGlucose(double mmol) {
+    m_usage.addGlucose(mmol, simNowMs());
+}
+
+void DataManager::recordBasal(MicroUnits delivered) {
+    m_usage.addBasal(delivered, simNowMs());
+}
+
+void DataManager::recordBolus(MicroUnits delivered, bool extended) {
+    m_usage.addBolus(delivered, extended, simNowMs());
+}
+
+void DataManager::recordExtendedBolusStep(MicroUnits delivered) {
+    m_usage.addBolusUnits(delivered, simNowMs());
+}
+
+void DataManager::recordTrace(const TraceCache& trace) {
+    m_imported.addTrace(trace.timestamps().data(), trace.glucose().data(),
+                        trace.bolus().data(), trace.basal().data(), trace.rows());
+}
+
 QString DataManager::analyzeUsage() const {
-    return "Usage analysis not implemented.";
+    QString live = summarize(m_usage);
+    QString summary = live.isEmpty() ? QString("No usage data recorded yet.") : "--- USAGE SUMMARY ---\n" + live;
+    QString imported = summarize(m_imported);
+    if (!imported.isEmpty())
+        summary += "\n--- IMPORTED HISTORY ---\n" + imported;
+    return summary;
+}
+
+QString DataManager::summarize(const UsageStats& u) {
+    if (u.glucoseSamples() == 0 && u.bolusCount() == 0 && u.totalBasal() == 0.0)
+        return QString();
+
+    return QString("CGM readings: %1\n"
+                   "Time in range (%2-%3 mmol/L): %4%\n"
+                   "Time below range: %5% | Time above range: %6%\n"
+                   "Mean glucose: %7 mmol/L | GMI (est. A1c): %8% | CV: %9%\n")
+               .arg(u.glucoseSamples())
+               .arg(UsageStats::kRangeLow, 0, 'f', 1)
+               .arg(UsageStats::kRangeHigh, 0, 'f', 1)
+               .arg(u.timeInRangePct(), 0, 'f', 1)
+               .arg(u.timeBelowRangePct(), 0, 'f', 1)
+               .arg(u.timeAboveRangePct(), 0, 'f', 1)
+               .arg(u.meanGlucose(), 0, 'f', 1)
+               .arg(u.glucoseManagementIndicator(), 0, 'f', 1)
+               .arg(u.coefficientOfVariationPct(), 0, 'f', 1)
+           + QString("Total daily dose: %1 u (basal %2 u / bolus %3 u)\n"
+                     "Boluses: %4 (%5 extended)")
+                 .arg(u.totalDailyDose(), 0, 'f', 1)
+                 .arg(u.dailyBasal(), 0, 'f', 1)
+                 .arg(u.dailyBolus(), 0, 'f', 1)
+                 .arg(u.bolusCount())
+                 .arg(u.extendedBolusCount());
+}
+
+const UsageStats& DataManager::usageStats() const {
+    return m_usage;
+}
+
+const UsageStats& DataManager::importedStats() const {
+    return m_imported;
+}
+
+std::int64_t DataManager::simNowMs() const {
+    return SimClock::toSimulated(m_sinceStart.elapsed());
 }
@@ -4,18 +4,75 @@
 #include <QString>
 #include <QStringList>
 #include <QDateTime>
+#include <QVector>
+#include <QElapsedTimer>
+#include <functional>
+#include "usagestats.h"
+#include "tracecache.h"
+
+// Event categories used to filter the history view
+enum class EventCategory {
+    Basal,
+    Bolus,
+    System,
+    Profile,
+    Settings,
+    Other,
+    Count
+};
 
 //--------------------------------------------------------
 // DATA MANAGER (New for event history logging)
 //--------------------------------------------------------
 class DataManager {
 public:
+    DataManager();
+
     void logEvent(const QString& event);
+    // Line already stamped by the logging thread
+    void logFormattedEvent(const QString& line, EventCategory category = EventCategory::Other);
+    // Batch form: one append notification for the whole batch
+    void logFormattedEvents(const QStringList& lines, const QVector<EventCategory>& categories);
     QString getHistory() const;
-    // Placeholder for potential future usage analysis.
+
+    // Indexed access for the history list model
+    int eventCount() const;
+    const QString& eventAt(int index) const;
+    EventCategory categoryAt(int index) const;
+    // Indexes of every event in a category, in logging order
+    const QVector<int>& eventsInCategory(EventCategory category) const;
+    // Called after every append (the history model listens here)
+    void setAppendListener(std::function<void()> listener);
+
+    static EventCategory categorize(const QString& event);
+    static QString categoryName(EventCategory category);
+
+    // Feed the live usage accumulators as readings and doses happen (stamped in simulated time)
+    void recordGlucose(double mmol);
+    void recordBasal(MicroUnits delivered);
+    // One call per bolus; extended boluses then report each step separately
+    void recordBolus(MicroUnits delivered, bool extended = false);
+    void recordExtendedBolusStep(MicroUnits delivered);
+    // Imported history, read straight from the cache mapping; kept apart from live usage
+    void recordTrace(const TraceCache& trace);
+
+    // Summary of the running usage metrics (O(1), never rescans the history)
     QString analyzeUsage() const;
+    const UsageStats& usageStats() const;
+    const UsageStats& importedStats() const;
+    // Pump time the live stats are stamped with (SimClock, from construction)
+    std::int64_t simNowMs() const;
 private:
+    void append(const QString& line, EventCategory category);
+    static QString summarize(const UsageStats& u);
+
     QStringList eventHistory;
+    QVector<EventCategory> m_categories;
+    QVector<int> m_categoryIndex[static_cast<int>(EventCategory::Count)];
+    std::function<void()> m_appendListener;
+    UsageStats m_usage;
+    UsageStats m_imported;
+    QElapsedTimer m_sinceStart;     // live stats run on SimClock time from here
 };
 
 #endif // DATAMANAGER_H
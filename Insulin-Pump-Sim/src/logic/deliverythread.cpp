@@ -0,0 +1,188 @@
+#include "deliverythread.h"
+#include "basalmanager.h"
+#include "logger.h"
+#include "handlertiming.h"
+#include <QTimer>
+#include <chrono>
+
+DeliveryThread::DeliveryThread(Battery* battery, InsulinCartridge* cartridge, IOB* iob, CGMSensor* sensor, QObject* parent)
+    : QObject(parent),
+    m_battery(battery),
+    m_cartridge(cartridge),
+    m_iob(iob),
+    m_sensor(sensor),
+    m_basalManager(nullptr),
+    m_activeBoluses(0),
+    m_thread(new QThread(this)),
+    m_context(new QObject()),
+    m_refreshQueued(false),
+    m_snapshotChanged(false)
+{
+    m_thread->setObjectName("delivery");
+    m_context->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_context, &QObject::deleteLater);
+    // First snapshot before the worker exists, so the GUI never reads an empty one
+    m_snapshot.store(PumpSnapshot::capture(*m_battery, *m_cartridge, *m_iob, *m_sensor));
+}
+
+DeliveryThread::~DeliveryThread() {
+    stop();
+}
+
+void DeliveryThread::start() {
+    if (!m_thread->isRunning()) {
+        m_thread->start(QThread::TimeCriticalPriority);
+        post([]() { PUMP_TRACE_THREAD("delivery"); });
+    }
+    m_watchdog.start();
+}
+
+void DeliveryThread::stop() {
+    if (!m_context)
+        return;
+    m_watchdog.stop();
+    m_cgm.stopProducer();
+    CgmIngest::Stats cgm = m_cgm.stats();
+    if (cgm.produced > 0)
+        Logger::instance().logf(LogChannel::Console, "[CGM] %llu produced, %llu consumed, %llu overruns, %llu gaps, %llu backfilled, %llu backfill dropped",
+                                static_cast<unsigned long long>(cgm.produced), static_cast<unsigned long long>(cgm.consumed),
+                                static_cast<unsigned long long>(cgm.overruns), static_cast<unsigned long long>(cgm.gaps),
+                                static_cast<unsigned long long>(cgm.backfilled), static_cast<unsigned long long>(cgm.backfillDropped));
+    // Heartbeat intervals, for sizing the tick periods
+    for (const HandlerSummary& task : m_watchdog.summaries())
+        Logger::instance().logf(LogChannel::Console, "[WATCHDOG] %s: %llu beats, p50 %.1f ms, p99 %.1f ms, max %.1f ms",
+                                task.name.c_str(), static_cast<unsigned long long>(task.count),
+                                task.p50Ms, task.p99Ms, task.maxMs);
+    if (m_thread->isRunning()) {
+        m_thread->quit();
+        m_thread->wait();   // finished() deleted the context
+    } else {
+        delete m_context;   // never started
+    }
+    m_context = nullptr;
+}
+
+void DeliveryThread::post(std::function<void()> work) {
+    if (!m_context)
+        return;
+    QMetaObject::invokeMethod(m_context, [this, work]() {
+        work();
+        publish();
+    }, Qt::QueuedConnection);
+}
+
+void DeliveryThread::toUi(std::function<void()> work) {
+    if (QThread::currentThread() == thread())
+        work();
+    else
+        QMetaObject::invokeMethod(this, work, Qt::QueuedConnection);
+}
+
+QObject* DeliveryThread::context() const {
+    return m_context;
+}
+
+void DeliveryThread::publish() {
+    PumpSnapshot snapshot = PumpSnapshot::capture(*m_battery, *m_cartridge, *m_iob, *m_sensor);
+    if (m_basalManager) {
+        snapshot.basalState = m_basalManager->state();
+        snapshot.basalRate = m_basalManager->lastRate();
+    }
+    snapshot.activeBoluses = m_activeBoluses;
+    m_snapshot.store(snapshot);
+    if (m_telemetry.isOpen()) {
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        m_telemetry.publish(TelemetryState::from(
+            snapshot, std::chrono::duration_cast<std::chrono::milliseconds>(now).count()));
+    }
+
+    m_snapshotChanged.store(true, std::memory_order_release);
+    notifyGui();
+}
+
+void DeliveryThread::notifyGui() {
+    // Several publishes before the GUI catches up cost one refresh
+    if (!m_refreshQueued.exchange(true, std::memory_order_acq_rel))
+        QMetaObject::invokeMethod(this, [this]() { refresh(); }, Qt::QueuedConnection);
+}
+
+void DeliveryThread::refresh() {
+    // Cleared first: anything recorded from here on posts a new refresh
+    m_refreshQueued.store(false, std::memory_order_seq_cst);
+    BasalSample sample;
+    while (m_basalSamples.tryPop(sample)) {
+        if (m_basalRecorded)
+            m_basalRecorded(sample);
+    }
+    if (m_snapshotChanged.exchange(false, std::memory_order_acquire) && m_published)
+        m_published();
+}
+
+void DeliveryThread::setBasalManager(BasalManager* basalManager) {
+    m_basalManager = basalManager;
+}
+
+DeliveryWatchdog& DeliveryThread::watchdog() {
+    return m_watchdog;
+}
+
+void DeliveryThread::startCgmFeed(CgmIngest::Source source, qint64 periodMs,
+                                  std::function<void(const CgmIngest::Batch&)> onReadings) {
+    if (!m_context)
+        return;
+    post([this, onReadings]() {
+        QTimer* drainTimer = new QTimer(m_context);
+        std::uint64_t reportedOverruns = 0;
+        connect(drainTimer, &QTimer::timeout, m_context, [this, onReadings, reportedOverruns]() mutable {
+            PUMP_TIME_HANDLER("DeliveryThread::drainCgm");
+            CgmIngest::Batch batch;
+            m_cgm.consume(*m_sensor, batch);
+            // The exit summary only reaches stdout; tell the event log as overruns happen
+            std::uint64_t overruns = m_cgm.stats().overruns;
+            if (overruns > reportedOverruns) {
+                Logger::instance().logf(LogChannel::Event, "[CGM] %llu readings dropped, ingest ring full",
+                                        static_cast<unsigned long long>(overruns - reportedOverruns));
+                reportedOverruns = overruns;
+            }
+            if (batch.empty())
+                return;
+            if (onReadings)
+                onReadings(batch);
+            publish();
+        });
+        drainTimer->start(kCgmDrainMs);
+    });
+    m_cgm.startProducer(std::move(source), periodMs);
+}
+
+CgmIngest::Stats DeliveryThread::cgmStats() const {
+    return m_cgm.stats();
+}
+
+bool DeliveryThread::openTelemetry(const std::string& name) {
+    if (!m_telemetry.open(name))
+        return false;
+    m_telemetry.publish(TelemetryState::from(snapshot(), 0));
+    return true;
+}
+
+void DeliveryThread::setActiveBoluses(int count) {
+    m_activeBoluses = count;
+}
+
+void DeliveryThread::recordBasal(const BasalSample& sample) {
+    m_basalSamples.tryPush(sample);
+    notifyGui();
+}
+
+PumpSnapshot DeliveryThread::snapshot() const {
+    return m_snapshot.load();
+}
+
+void DeliveryThread::setPublishedCallback(std::function<void()> callback) {
+    m_published = std::move(callback);
+}
+
+void DeliveryThread::setBasalCallback(std::function<void(const BasalSample&)> callback) {
+    m_basalRecorded = std::move(callback);
+}
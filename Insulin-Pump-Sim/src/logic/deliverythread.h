@@ -0,0 +1,99 @@
+#ifndef DELIVERYTHREAD_H
+#define DELIVERYTHREAD_H
+
+#include <QObject>
+#include <QThread>
+#include <atomic>
+#include <functional>
+#include "src/models/battery.h"
+#include "src/models/insulincartridge.h"
+#include "src/models/iob.h"
+#include "src/models/cgmsensor.h"
+#include "pumpsnapshot.h"
+#include "seqlock.h"
+#include "deliverywatchdog.h"
+#include "cgmingest.h"
+#include "basalengine.h"
+#include "telemetryfeed.h"
+
+class BasalManager;
+
+//--------------------------------------------------------
+// DELIVERY THREAD (owns every write to the pump models)
+// Basal, bolus, CGM and IOB work runs on a time-critical
+// worker. The GUI posts commands with post(), reads
+// snapshot(), and gets one coalesced refresh for any number
+// of changes.
+//--------------------------------------------------------
+class DeliveryThread : public QObject {
+    Q_OBJECT
+public:
+    static constexpr int kCgmDrainMs = 1000;
+
+    DeliveryThread(Battery* battery,
+                   InsulinCartridge* cartridge,
+                   IOB* iob,
+                   CGMSensor* sensor,
+                   QObject* parent = nullptr);
+    ~DeliveryThread();
+
+    void start();
+    // Joins the thread; objects parented to context() are deleted
+    void stop();
+
+    // Run on the delivery thread, then republish the snapshot
+    void post(std::function<void()> work);
+    // Run on the GUI thread (directly when already there)
+    void toUi(std::function<void()> work);
+    // Parent / context for timers and managers living on the delivery thread
+    QObject* context() const;
+
+    // Delivery thread only
+    void publish();
+    void setBasalManager(BasalManager* basalManager);
+    DeliveryWatchdog& watchdog();
+
+    // Start a CGM producer thread; onReadings runs on the delivery thread per drained batch
+    void startCgmFeed(CgmIngest::Source source, qint64 periodMs,
+                      std::function<void(const CgmIngest::Batch&)> onReadings);
+    CgmIngest::Stats cgmStats() const;
+
+    // Before start(): mirror every snapshot into a POSIX shm segment
+    bool openTelemetry(const std::string& name);
+    // Delivery thread only; reported in the next snapshot
+    void setActiveBoluses(int count);
+    // Delivery thread only; allocation free, dropped if the GUI is 256 ticks behind
+    void recordBasal(const BasalSample& sample);
+
+    // Any thread, never blocks the writer
+    PumpSnapshot snapshot() const;
+    // GUI callback after a new snapshot was published
+    void setPublishedCallback(std::function<void()> callback);
+    // GUI callback for each basal sample, in tick order
+    void setBasalCallback(std::function<void(const BasalSample&)> callback);
+
+private:
+    Battery* m_battery;
+    InsulinCartridge* m_cartridge;
+    IOB* m_iob;
+    CGMSensor* m_sensor;
+    BasalManager* m_basalManager;
+
+    QThread* m_thread;
+    QObject* m_context;
+    SeqLock<PumpSnapshot> m_snapshot;
+    DeliveryWatchdog m_watchdog;
+    CgmIngest m_cgm;
+    TelemetryFeed m_telemetry;
+    int m_activeBoluses;
+    BasalSampleRing m_basalSamples;
+    std::atomic<bool> m_refreshQueued;     // a refresh is posted and not yet run
+    std::atomic<bool> m_snapshotChanged;
+    std::function<void()> m_published;
+    std::function<void(const BasalSample&)> m_basalRecorded;
+
+    void notifyGui();
+    void refresh();   // GUI thread
+};
+
+#endif // DELIVERYTHREAD_H
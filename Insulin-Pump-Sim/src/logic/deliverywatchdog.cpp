@@ -0,0 +1,130 @@
+#include "deliverywatchdog.h"
+#include "eventtrace.h"
+
+namespace {
+constexpr std::int64_t kNanosPerMs = 1000000;
+}
+
+DeliveryWatchdog::DeliveryWatchdog() : m_stopping(false), m_misses(0) {}
+
+DeliveryWatchdog::~DeliveryWatchdog() {
+    stop();
+}
+
+void DeliveryWatchdog::start() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_thread.joinable())
+        return;
+    m_stopping = false;
+    m_thread = std::thread([this]() { run(); });
+}
+
+void DeliveryWatchdog::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void DeliveryWatchdog::setMissHandler(MissHandler handler) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_onMiss = std::move(handler);
+}
+
+int DeliveryWatchdog::watch(const std::string& name, std::int64_t deadlineMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (int id = 0; id < kMaxTasks; id++) {
+        Task& task = m_tasks[id];
+        if (task.active.load(std::memory_order_relaxed))
+            continue;
+        m_names[id] = name;
+        task.intervals.reset();
+        task.deadlineNs.store(deadlineMs * kNanosPerMs, std::memory_order_relaxed);
+        task.lastBeatNs.store(nowNs(), std::memory_order_relaxed);
+        task.tripped.store(false, std::memory_order_relaxed);
+        task.active.store(true, std::memory_order_release);
+        return id;
+    }
+    return -1;
+}
+
+void DeliveryWatchdog::setDeadline(int id, std::int64_t deadlineMs) {
+    if (id >= 0 && id < kMaxTasks)
+        m_tasks[id].deadlineNs.store(deadlineMs * kNanosPerMs, std::memory_order_relaxed);
+}
+
+void DeliveryWatchdog::heartbeat(int id) {
+    if (id < 0 || id >= kMaxTasks)
+        return;
+    Task& task = m_tasks[id];
+    std::int64_t now = nowNs();
+    std::int64_t previous = task.lastBeatNs.exchange(now, std::memory_order_release);
+    task.intervals.record(static_cast<std::uint64_t>(now - previous));
+    task.tripped.store(false, std::memory_order_relaxed);
+}
+
+void DeliveryWatchdog::release(int id) {
+    if (id >= 0 && id < kMaxTasks)
+        m_tasks[id].active.store(false, std::memory_order_release);
+}
+
+std::vector<HandlerSummary> DeliveryWatchdog::summaries() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<HandlerSummary> result;
+    for (int id = 0; id < kMaxTasks; id++) {
+        if (m_tasks[id].intervals.count() > 0)
+            result.push_back(m_tasks[id].intervals.summarize(m_names[id]));
+    }
+    return result;
+}
+
+std::uint64_t DeliveryWatchdog::missCount() const {
+    return m_misses.load(std::memory_order_relaxed);
+}
+
+std::int64_t DeliveryWatchdog::nowNs() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void DeliveryWatchdog::run() {
+    PUMP_TRACE_THREAD("watchdog");
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        m_wake.wait_for(lock, std::chrono::milliseconds(kCheckIntervalMs));
+        if (m_stopping)
+            break;
+        lock.unlock();
+        check();
+        lock.lock();
+    }
+}
+
+void DeliveryWatchdog::check() {
+    std::int64_t now = nowNs();
+    for (int id = 0; id < kMaxTasks; id++) {
+        Task& task = m_tasks[id];
+        if (!task.active.load(std::memory_order_acquire) || task.tripped.load(std::memory_order_relaxed))
+            continue;
+        std::int64_t late = now - task.lastBeatNs.load(std::memory_order_acquire)
+                            - task.deadlineNs.load(std::memory_order_relaxed);
+        if (late <= 0)
+            continue;
+        // Trip once; the next heartbeat re-arms the task
+        task.tripped.store(true, std::memory_order_relaxed);
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+
+        std::string name;
+        MissHandler onMiss;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            name = m_names[id];
+            onMiss = m_onMiss;
+        }
+        if (onMiss)
+            onMiss(name, late / kNanosPerMs);
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef DELIVERYWATCHDOG_H
+#define DELIVERYWATCHDOG_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "handlertiming.h"
+
+//--------------------------------------------------------
+// DELIVERY WATCHDOG (deadline monitor for delivery loops)
+// Each periodic delivery task (basal ticks, bolus steps)
+// registers with a deadline and calls heartbeat() every
+// period. A separate thread checks the tasks every 100 ms;
+// a task silent for longer than its deadline trips once and
+// the miss handler runs on the watchdog thread. Heartbeats
+// are lock-free, and the interval between them goes into a
+// per-task histogram for sizing periods against real load.
+//--------------------------------------------------------
+class DeliveryWatchdog {
+public:
+    static constexpr int kMaxTasks = 16;
+    static constexpr int kDefaultMissFactor = 2;   // deadline = period x this
+    static constexpr std::int64_t kCheckIntervalMs = 100;
+
+    // Task name and how far past its deadline it was
+    using MissHandler = std::function<void(const std::string& task, std::int64_t lateMs)>;
+
+    DeliveryWatchdog();
+    ~DeliveryWatchdog();
+
+    void start();
+    void stop();
+    void setMissHandler(MissHandler handler);
+
+    // Returns a task id, or -1 when every slot is in use
+    int watch(const std::string& name, std::int64_t deadlineMs);
+    void setDeadline(int id, std::int64_t deadlineMs);
+    void heartbeat(int id);
+    // Task finished or paused; the id may be reused
+    void release(int id);
+
+    // Heartbeat intervals per task (kept after release until the slot is reused)
+    std::vector<HandlerSummary> summaries() const;
+    std::uint64_t missCount() const;
+
+private:
+    struct Task {
+        std::atomic<bool> active{false};
+        std::atomic<bool> tripped{false};
+        std::atomic<std::int64_t> lastBeatNs{0};
+        std::atomic<std::int64_t> deadlineNs{0};
+        LatencyHistogram intervals;
+    };
+
+    static std::int64_t nowNs();
+    void run();
+    void check();
+
+    std::array<Task, kMaxTasks> m_tasks;
+    std::array<std::string, kMaxTasks> m_names;     // guarded by m_mutex
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping;
+    std::thread m_thread;
+    MissHandler m_onMiss;
+    std::atomic<std::uint64_t> m_misses;
+};
+
+#endif // DELIVERYWATCHDOG_H
@@ -0,0 +1,123 @@
+#include "eventtrace.h"
+#include <chrono>
+#include <cstdio>
+
+namespace {
+// Names are literals; escape the two characters JSON cares about
+void writeName(std::FILE* out, const char* name) {
+    std::fputc('"', out);
+    for (const char* c = name; *c; c++) {
+        if (*c == '"' || *c == '\\')
+            std::fputc('\\', out);
+        std::fputc(*c, out);
+    }
+    std::fputc('"', out);
+}
+}
+
+EventTrace& EventTrace::instance() {
+    static EventTrace trace;
+    return trace;
+}
+
+EventTrace::EventTrace()
+    : m_enabled(false),
+    m_originNs(0)
+{}
+
+std::int64_t EventTrace::nowNs() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void EventTrace::start(const std::string& path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_path = path;
+    m_originNs = nowNs();
+    for (auto& buffer : m_buffers) {
+        buffer->size.store(0, std::memory_order_relaxed);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+    }
+    m_enabled.store(true, std::memory_order_release);
+}
+
+bool EventTrace::stop() {
+    if (!m_enabled.exchange(false))
+        return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::FILE* out = std::fopen(m_path.c_str(), "w");
+    if (!out)
+        return false;
+
+    std::uint64_t dropped = 0;
+    std::fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for (const auto& buffer : m_buffers) {
+        std::fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+                     first ? "" : ",\n", buffer->tid);
+        writeName(out, buffer->name.empty() ? "thread" : buffer->name.c_str());
+        std::fprintf(out, "}}");
+        first = false;
+
+        // Writers may still be appending; only published slots are read
+        std::size_t size = buffer->size.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < size; i++) {
+            const Event& event = buffer->events[i];
+            double ts = (event.startNs - m_originNs) / 1000.0;
+            std::fprintf(out, ",\n{\"name\":");
+            writeName(out, event.name);
+            if (event.durationNs >= 0)
+                std::fprintf(out, ",\"cat\":\"pump\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                             buffer->tid, ts, event.durationNs / 1000.0);
+            else
+                std::fprintf(out, ",\"cat\":\"pump\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}",
+                             buffer->tid, ts);
+        }
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    std::fprintf(out, "\n],\"otherData\":{\"droppedEvents\":%llu}}\n", static_cast<unsigned long long>(dropped));
+    return std::fclose(out) == 0;
+}
+
+void EventTrace::span(const char* name, std::int64_t startNs, std::int64_t endNs) {
+    append(name, startNs, endNs - startNs);
+}
+
+void EventTrace::instant(const char* name) {
+    append(name, nowNs(), -1);
+}
+
+void EventTrace::setThreadName(const char* name) {
+    ThreadBuffer* buffer = local();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    buffer->name = name;
+}
+
+EventTrace::ThreadBuffer* EventTrace::local() {
+    // Buffers outlive their threads, so the trace can still be written
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = m_buffers.back().get();
+        buffer->tid = static_cast<int>(m_buffers.size());
+        buffer->size.store(0, std::memory_order_relaxed);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+    }
+    return buffer;
+}
+
+void EventTrace::append(const char* name, std::int64_t startNs, std::int64_t durationNs) {
+    if (!enabled())
+        return;
+    ThreadBuffer* buffer = local();
+    if (!buffer->events)
+        buffer->events.reset(new Event[kEventsPerThread]);
+    std::size_t size = buffer->size.load(std::memory_order_relaxed);
+    if (size == kEventsPerThread) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->events[size] = Event{name, startNs, durationNs};
+    buffer->size.store(size + 1, std::memory_order_release);
+}
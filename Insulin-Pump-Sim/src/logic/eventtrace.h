@@ -0,0 +1,77 @@
+#ifndef EVENTTRACE_H
+#define EVENTTRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//--------------------------------------------------------
+// EVENT TRACE (timeline of handler spans and instants)
+// Off until start(path). Every PUMP_TIME_HANDLER scope then
+// also lands here as a span, and PUMP_TRACE_INSTANT marks
+// single points (CGM updates). Each thread appends to its own
+// fixed-size buffer with no locking; a full buffer drops and
+// counts. stop() writes Chrome trace-event JSON, which both
+// chrome://tracing and ui.perfetto.dev open, with one row per
+// thread named by PUMP_TRACE_THREAD. Event names must be
+// string literals. Without PUMP_INSTRUMENTATION the macros
+// expand to nothing.
+//--------------------------------------------------------
+class EventTrace {
+public:
+    static constexpr std::size_t kEventsPerThread = 1 << 16;
+
+    static EventTrace& instance();
+
+    void start(const std::string& path);
+    // Write the trace; false if it was not running or the file failed
+    bool stop();
+    bool enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    void span(const char* name, std::int64_t startNs, std::int64_t endNs);
+    void instant(const char* name);
+    // Label the calling thread's row
+    void setThreadName(const char* name);
+
+    static std::int64_t nowNs();
+
+private:
+    struct Event {
+        const char* name;
+        std::int64_t startNs;
+        std::int64_t durationNs;   // -1 for instants
+    };
+
+    struct ThreadBuffer {
+        int tid;
+        std::string name;
+        std::unique_ptr<Event[]> events;    // allocated on the first event
+        std::atomic<std::size_t> size;
+        std::atomic<std::uint64_t> dropped;
+    };
+
+    EventTrace();
+    ThreadBuffer* local();
+    void append(const char* name, std::int64_t startNs, std::int64_t durationNs);
+
+    std::atomic<bool> m_enabled;
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+    std::string m_path;
+    std::int64_t m_originNs;
+};
+
+#ifdef PUMP_INSTRUMENTATION
+#define PUMP_TRACE_INSTANT(name) \
+    do { if (EventTrace::instance().enabled()) EventTrace::instance().instant(name); } while (0)
+#define PUMP_TRACE_THREAD(name) EventTrace::instance().setThreadName(name)
+#else
+#define PUMP_TRACE_INSTANT(name) static_cast<void>(0)
+#define PUMP_TRACE_THREAD(name) static_cast<void>(0)
+#endif
+
+#endif // EVENTTRACE_H
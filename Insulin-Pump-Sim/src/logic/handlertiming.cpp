@@ -0,0 +1,140 @@
+#include "handlertiming.h"
+#include <algorithm>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+constexpr double kNanosPerMs = 1e6;
+
+int highestBit(std::uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+}
+
+LatencyHistogram::LatencyHistogram() : m_count(0), m_max(0) {
+    for (auto& bucket : m_buckets)
+        bucket.store(0, std::memory_order_relaxed);
+}
+
+int LatencyHistogram::bucketFor(std::uint64_t nanos) {
+    if (nanos < kSubBuckets)
+        return static_cast<int>(nanos);
+    int msb = highestBit(nanos);
+    // Two bits below the leading one pick the sub-bucket
+    int sub = static_cast<int>((nanos >> (msb - 2)) & (kSubBuckets - 1));
+    return msb * kSubBuckets + sub;
+}
+
+std::uint64_t LatencyHistogram::bucketUpperBound(int bucket) {
+    if (bucket < kSubBuckets)
+        return static_cast<std::uint64_t>(bucket);
+    int msb = bucket / kSubBuckets;
+    int sub = bucket % kSubBuckets;
+    std::uint64_t base = 1ULL << msb;
+    std::uint64_t step = base / kSubBuckets;
+    return base + step * (sub + 1) - 1;
+}
+
+void LatencyHistogram::record(std::uint64_t nanos) {
+    m_buckets[bucketFor(nanos)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    std::uint64_t seen = m_max.load(std::memory_order_relaxed);
+    while (nanos > seen && !m_max.compare_exchange_weak(seen, nanos, std::memory_order_relaxed)) {}
+}
+
+std::uint64_t LatencyHistogram::count() const {
+    return m_count.load(std::memory_order_relaxed);
+}
+
+std::uint64_t LatencyHistogram::percentile(double p) const {
+    std::uint64_t total = count();
+    if (total == 0)
+        return 0;
+    std::uint64_t rank = static_cast<std::uint64_t>(p * total);
+    if (rank >= total)
+        rank = total - 1;
+    std::uint64_t seen = 0;
+    for (int b = 0; b < kBuckets; b++) {
+        seen += m_buckets[b].load(std::memory_order_relaxed);
+        if (seen > rank)
+            return std::min(bucketUpperBound(b), max());
+    }
+    return max();
+}
+
+std::uint64_t LatencyHistogram::max() const {
+    return m_max.load(std::memory_order_relaxed);
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : m_buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+HandlerSummary LatencyHistogram::summarize(const std::string& name) const {
+    return HandlerSummary{name,
+                          count(),
+                          percentile(0.50) / kNanosPerMs,
+                          percentile(0.99) / kNanosPerMs,
+                          max() / kNanosPerMs};
+}
+
+HandlerTiming::HandlerTiming() : m_handlerCount(0) {}
+
+HandlerTiming& HandlerTiming::instance() {
+    static HandlerTiming timing;
+    return timing;
+}
+
+int HandlerTiming::registerHandler(const char* name) {
+    std::lock_guard<std::mutex> lock(m_registerMutex);
+    int count = m_handlerCount.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; i++) {
+        if (m_names[i] == name)
+            return i;
+    }
+    if (count >= kMaxHandlers)
+        return -1;
+    m_names[count] = name;
+    m_handlerCount.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+void HandlerTiming::record(int id, std::uint64_t nanos) {
+    if (id >= 0)
+        m_histograms[id].record(nanos);
+}
+
+void HandlerTiming::recordEventLoopLag(std::uint64_t nanos) {
+    m_eventLoopLag.record(nanos);
+}
+
+HandlerSummary HandlerTiming::eventLoopLag() const {
+    return m_eventLoopLag.summarize("event loop lag");
+}
+
+std::vector<HandlerSummary> HandlerTiming::summaries() const {
+    std::lock_guard<std::mutex> lock(m_registerMutex);
+    std::vector<HandlerSummary> result;
+    int count = m_handlerCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count; i++) {
+        if (m_histograms[i].count() > 0)
+            result.push_back(m_histograms[i].summarize(m_names[i]));
+    }
+    return result;
+}
+
+void HandlerTiming::reset() {
+    for (auto& histogram : m_histograms)
+        histogram.reset();
+    m_eventLoopLag.reset();
+}
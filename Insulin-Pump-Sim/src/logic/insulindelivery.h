@@ -4,51 +4,104 @@
 #include <QObject>
 #include <functional>
 #include "src/models/profile.h"
+#include "src/models/profilemanager.h"
 #include "src/models/battery.h"
 #include "src/models/insulincartridge.h"
 #include "src/models/iob.h"
 #include "src/models/cgmsensor.h"
 #include "basalmanager.h"
 #include "bolusmanager.h"
+#include "datamanager.h"
+#include "deliverythread.h"
+#include <string>
+#include <vector>
 
 class QWidget;
+class QTimer;
 
+//--------------------------------------------------------
+// INSULIN DELIVERY (GUI front end of the delivery thread)
+// Public methods run on the GUI thread; every dose, timer and
+// model write is posted to the DeliveryThread. The running
+// basal reads a private copy of its profile that syncProfile()
+// keeps in step with edits, deletes and profile switches on
+// the GUI side.
+//--------------------------------------------------------
 class InsulinDelivery : public QObject {
     Q_OBJECT
 public:
     // Constructor
-    InsulinDelivery(Profile*& currentProfile,
+    InsulinDelivery(ProfileManager* profileManager,
+                              ProfileHandle& currentProfile,
                               Battery* battery,
                               InsulinCartridge* cartridge,
                               IOB* iob,
                               CGMSensor* sensor,
+                              DataManager* dataManager,
+                              DeliveryThread* delivery,
                               std::function<void(const QString&)> addLogCallback,
-                              std::function<void()> updateStatusCallback,
                               std::function<void(const QString&)> updateBasalStatusCallback,
                               QObject* parent = nullptr);
     //bolus calculation
     void launchBolusDialog(QWidget* parentWidget);
+    // Immediate bolus; a shortfall warns in a box over parentWidget, or in the log without one
+    void deliverBolus(double bolus, QWidget* parentWidget = nullptr);
     //  (start/pause/resume)
     void toggleBasalDelivery();
     // Starts basal delyver
     void startBasalDelivery();
     // Update the profile.
-    void setCurrentProfile(Profile* profile);
-    void stopAllDelivery();
+    void setCurrentProfile(ProfileHandle profile);
+    // Push edits / deletion of the basal's profile to the delivery thread
+    void syncProfile();
+    // Stops basal and every running bolus task
+    void stopAllDelivery(const QString& reason = "System Crash");
 
 
 private:
-    Profile*& m_currentProfile;
+    Profile* currentProfile() const;
+    // GUI side of a stop: status text and log line
+    void reportStopped(const QString& reason);
+    // New basal manager for the current profile, replacing any old one
+    void restartBasal();
+    // Delivery thread helpers
+    void haltDelivery();
+    void mirrorProfile(const Profile& profile);
+    BasalManager* createBasalManager();
+    void setBasalStatus(const QString& status);
+    // Cartridge -> IOB; returns what was delivered
+    MicroUnits dose(double units);
+    // DataManager lives on the GUI thread
+    void recordData(std::function<void(DataManager*)> record);
+    // Repeat step every periodMs until it returns false, under the watchdog
+    void startTask(const std::string& name, int periodMs, std::function<bool()> step, bool bolus = false);
+    void finishTask(QTimer* timer);
+    void countActiveBoluses();
+
+    struct Task {
+        QTimer* timer;
+        int watchId;
+        bool bolus;     // counts as an active bolus
+    };
+
+    ProfileManager* m_profileManager;
+    ProfileHandle& m_currentProfile;
     Battery* m_battery;
     InsulinCartridge* m_cartridge;
     IOB* m_iob;
     CGMSensor* m_sensor;
+    DataManager* m_dataManager;
+    DeliveryThread* m_delivery;
     std::function<void(const QString&)> m_addLog;
-    std::function<void()> m_updateStatus;
     std::function<void(const QString&)> m_updateBasalStatus;
+    ProfileHandle m_basalProfile;        // GUI side: profile the basal was started with
+    bool m_basalStarted;                 // the last start got past canStart()
+
+    // Delivery thread only
+    ProfileManager m_deliveryProfiles;
+    ProfileHandle m_deliveryProfile;
     BasalManager* m_basalManager;
-    bool m_basalRunning;
-    bool m_basalPaused;
+    std::vector<Task> m_tasks;
 };
 
 #endif // INSULINDELIVERYCONTROLLER_H
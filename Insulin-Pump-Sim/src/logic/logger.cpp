@@ -0,0 +1,290 @@
+#include "logger.h"
+#include "handlertiming.h"
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+namespace {
+constexpr std::size_t kMask = Logger::kCapacity - 1;
+static_assert((Logger::kCapacity & kMask) == 0, "capacity must be a power of two");
+
+std::int64_t nowMs() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+// Longest prefix of text[0, length) that ends on a UTF-8 character boundary
+std::size_t utf8Prefix(const char* text, std::size_t length) {
+    std::size_t lead = length;
+    while (lead > 0 && length - lead < 4 && (static_cast<unsigned char>(text[lead - 1]) & 0xC0) == 0x80)
+        lead--;
+    if (lead == 0)
+        return length;
+    unsigned char c = static_cast<unsigned char>(text[lead - 1]);
+    std::size_t need = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+    return length - (lead - 1) >= need ? length : lead - 1;
+}
+
+std::string stamp(std::int64_t timestampMs, const std::string& text) {
+    std::time_t seconds = static_cast<std::time_t>(timestampMs / 1000);
+    std::tm local{};
+#if defined(_WIN32)
+    localtime_s(&local, &seconds);
+#else
+    localtime_r(&seconds, &local);
+#endif
+    char prefix[32];
+    std::size_t n = std::strftime(prefix, sizeof(prefix), "%Y-%m-%d %H:%M:%S - ", &local);
+    std::string line;
+    line.reserve(n + text.size());
+    line.append(prefix, n);
+    line.append(text);
+    return line;
+}
+}
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger()
+    : m_slots(new Slot[kCapacity]),
+    m_enqueuePos(0),
+    m_dequeuePos(0),
+    m_consumed(0),
+    m_dropped(0),
+    m_backpressure(0),
+    m_reportedDropped(0),
+    m_nextSinkId(1),
+    m_sleeping(false),
+    m_flushWaiters(0),
+    m_running(true)
+{
+    for (std::size_t i = 0; i < kCapacity; i++)
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+
+    // Console output used to go straight to std::cout from each class
+    addSink([](const std::vector<LogEntry>& batch) {
+        bool wrote = false;
+        for (const LogEntry& entry : batch) {
+            if (entry.channel == LogChannel::Console) {
+                std::cout << entry.text << '\n';
+                wrote = true;
+            }
+        }
+        if (wrote)
+            std::cout.flush();
+    });
+
+    m_thread = std::thread(&Logger::run, this);
+}
+
+Logger::~Logger() {
+    shutdown();
+}
+
+Logger::Slot* Logger::claim(std::size_t& position) {
+    position = m_enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = m_slots[position & kMask];
+        std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        std::intptr_t diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+        if (diff == 0) {
+            if (m_enqueuePos.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            // Ring full: drop instead of waiting on the consumer
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            position = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Producers running more than 3/4 of the ring ahead of the consumer
+    if (position - m_consumed.load(std::memory_order_relaxed) > kCapacity * 3 / 4)
+        m_backpressure.fetch_add(1, std::memory_order_relaxed);
+
+    Slot* slot = &m_slots[position & kMask];
+    slot->timestampMs = nowMs();
+    return slot;
+}
+
+void Logger::publish(Slot* slot, std::size_t position) {
+    slot->sequence.store(position + 1, std::memory_order_release);
+    // Pairs with the fence in waitForWork(): either the consumer sees this
+    // slot before sleeping, or this producer sees it asleep and wakes it
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleeping.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_wake.notify_one();
+    }
+}
+
+bool Logger::log(LogChannel channel, const char* text, std::size_t length) {
+    std::size_t position;
+    Slot* slot = claim(position);
+    if (!slot)
+        return false;
+    if (length > kMaxText)
+        length = utf8Prefix(text, kMaxText);
+    std::memcpy(slot->text, text, length);
+    slot->length = static_cast<std::uint16_t>(length);
+    slot->channel = channel;
+    publish(slot, position);
+    return true;
+}
+
+bool Logger::log(LogChannel channel, const std::string& text) {
+    return log(channel, text.data(), text.size());
+}
+
+bool Logger::logf(LogChannel channel, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    bool logged = vlogf(channel, format, args);
+    va_end(args);
+    return logged;
+}
+
+bool Logger::vlogf(LogChannel channel, const char* format, va_list args) {
+    std::size_t position;
+    Slot* slot = claim(position);
+    if (!slot)
+        return false;
+    int n = std::vsnprintf(slot->text, kMaxText, format, args);
+    std::size_t length = n < 0 ? 0 : static_cast<std::size_t>(n);
+    if (length >= kMaxText)
+        length = utf8Prefix(slot->text, kMaxText - 1);
+    slot->length = static_cast<std::uint16_t>(length);
+    slot->channel = channel;
+    publish(slot, position);
+    return true;
+}
+
+int Logger::addSink(Sink sink) {
+    std::lock_guard<std::mutex> lock(m_sinkMutex);
+    int id = m_nextSinkId++;
+    m_sinks.emplace_back(id, std::move(sink));
+    return id;
+}
+
+void Logger::removeSink(int id) {
+    std::lock_guard<std::mutex> lock(m_sinkMutex);
+    for (auto it = m_sinks.begin(); it != m_sinks.end(); ++it) {
+        if (it->first == id) {
+            m_sinks.erase(it);
+            return;
+        }
+    }
+}
+
+// Returns the number of ring entries taken; a report line may follow them
+std::size_t Logger::drain(std::vector<LogEntry>& batch) {
+    batch.clear();
+    std::size_t taken = 0;
+    for (; taken < kMaxBatch; taken++) {
+        Slot& slot = m_slots[m_dequeuePos & kMask];
+        std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != m_dequeuePos + 1)
+            break;
+        LogEntry entry;
+        entry.timestampMs = slot.timestampMs;
+        entry.channel = slot.channel;
+        entry.text.assign(slot.text, slot.length);
+        slot.sequence.store(m_dequeuePos + kCapacity, std::memory_order_release);
+        m_dequeuePos++;
+        batch.push_back(std::move(entry));
+    }
+
+    std::uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+    if (dropped != m_reportedDropped) {
+        LogEntry entry;
+        entry.timestampMs = nowMs();
+        entry.channel = LogChannel::Console;
+        entry.text = "[Logger] Dropped " + std::to_string(dropped - m_reportedDropped) + " messages (queue full)";
+        m_reportedDropped = dropped;
+        batch.push_back(std::move(entry));
+    }
+
+    // Formatting happens here, once per batch, off the producers' threads
+    for (LogEntry& entry : batch)
+        entry.stamped = stamp(entry.timestampMs, entry.text);
+    return taken;
+}
+
+bool Logger::hasPending() const {
+    return m_slots[m_dequeuePos & kMask].sequence.load(std::memory_order_acquire) == m_dequeuePos + 1;
+}
+
+void Logger::waitForWork() {
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    m_sleeping.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    m_wake.wait(lock, [this]() {
+        return hasPending() || !m_running.load(std::memory_order_acquire);
+    });
+    m_sleeping.store(false, std::memory_order_relaxed);
+}
+
+void Logger::run() {
+    PUMP_TRACE_THREAD("logger");
+    std::vector<LogEntry> batch;
+    batch.reserve(kMaxBatch + 1);
+    for (;;) {
+        bool running = m_running.load(std::memory_order_acquire);
+        std::size_t taken = drain(batch);
+        if (!batch.empty()) {
+            PUMP_TIME_HANDLER("Logger::flush");
+            std::lock_guard<std::mutex> lock(m_sinkMutex);
+            for (auto& sink : m_sinks)
+                sink.second(batch);
+        }
+        m_consumed.store(m_dequeuePos, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            if (m_flushWaiters > 0)
+                m_drained.notify_all();
+        }
+        if (taken == kMaxBatch)
+            continue;
+        if (!running)
+            break;
+        waitForWork();
+    }
+}
+
+void Logger::flush() {
+    std::size_t target = m_enqueuePos.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    m_flushWaiters++;
+    m_drained.wait(lock, [this, target]() {
+        return !m_running.load(std::memory_order_acquire)
+               || m_consumed.load(std::memory_order_acquire) >= target;
+    });
+    m_flushWaiters--;
+}
+
+void Logger::shutdown() {
+    if (!m_running.exchange(false))
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_wake.notify_one();
+        m_drained.notify_all();
+    }
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+std::uint64_t Logger::droppedCount() const {
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+std::uint64_t Logger::backpressureCount() const {
+    return m_backpressure.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,115 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//--------------------------------------------------------
+// LOGGER (single logging front end)
+// Producers on any thread copy their message into a slot of a
+// bounded lock-free MPSC ring and return. A background thread
+// drains the ring in batches, stamps the time and hands each
+// batch to the registered sinks, and sleeps on a condition
+// variable while the ring is empty; a producer only touches
+// the mutex to wake it. A full ring drops the message and
+// counts it; the producer never waits on the consumer or
+// allocates. Truncation keeps whole UTF-8 characters.
+//--------------------------------------------------------
+enum class LogChannel : std::uint8_t {
+    Event,   // pump event log: UI + history
+    Console  // developer trace output (stdout)
+};
+
+struct LogEntry {
+    std::int64_t timestampMs;
+    LogChannel channel;
+    std::string text;
+    std::string stamped;  // "yyyy-MM-dd hh:mm:ss - text"
+};
+
+class Logger {
+public:
+    static constexpr std::size_t kCapacity = 4096;    // ring slots (power of two)
+    static constexpr std::size_t kMaxText = 240;      // longer messages are truncated
+    static constexpr std::size_t kMaxBatch = 512;
+
+    using Sink = std::function<void(const std::vector<LogEntry>&)>;
+
+    static Logger& instance();
+
+    // Producer side: bounded cost, safe from any thread
+    bool log(LogChannel channel, const char* text, std::size_t length);
+    bool log(LogChannel channel, const std::string& text);
+    bool logf(LogChannel channel, const char* format, ...)
+#if defined(__GNUC__)
+        __attribute__((format(printf, 3, 4)))
+#endif
+        ;
+    bool vlogf(LogChannel channel, const char* format, va_list args);
+
+    // Sinks run on the logging thread; returns an id for removeSink
+    int addSink(Sink sink);
+    void removeSink(int id);
+
+    // Block until everything pushed so far reached the sinks
+    void flush();
+    // Drain and stop the logging thread (called once at exit)
+    void shutdown();
+
+    std::uint64_t droppedCount() const;
+    // Messages logged while the ring was more than 3/4 full
+    std::uint64_t backpressureCount() const;
+
+private:
+    Logger();
+    ~Logger();
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        std::int64_t timestampMs;
+        LogChannel channel;
+        std::uint16_t length;
+        char text[kMaxText];
+    };
+
+    Slot* claim(std::size_t& position);
+    void publish(Slot* slot, std::size_t position);
+    std::size_t drain(std::vector<LogEntry>& batch);
+    bool hasPending() const;
+    void waitForWork();
+    void run();
+
+    std::unique_ptr<Slot[]> m_slots;
+    alignas(64) std::atomic<std::size_t> m_enqueuePos;
+    alignas(64) std::size_t m_dequeuePos;
+    std::atomic<std::size_t> m_consumed;
+    alignas(64) std::atomic<std::uint64_t> m_dropped;
+    std::atomic<std::uint64_t> m_backpressure;
+    std::uint64_t m_reportedDropped;
+
+    std::mutex m_sinkMutex;
+    std::vector<std::pair<int, Sink>> m_sinks;
+    int m_nextSinkId;
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;       // ring no longer empty, or shutdown
+    std::condition_variable m_drained;    // m_consumed moved, for flush()
+    std::atomic<bool> m_sleeping;
+    int m_flushWaiters;                   // guarded by m_wakeMutex
+
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+};
+
+#endif // LOGGER_H
@@ -1,15 +1,33 @@
 #include "navigationmanager.h"
+#include "logger.h"
+#include <chrono>
 
 NavigationManager::NavigationManager(QStackedWidget* stack) : m_stack(stack) {}
 
+void NavigationManager::registerPage(const QString& screen, PageFactory factory) {
+    Page page;
+    page.factory = std::move(factory);
+    m_pages.insert(screen, page);
+}
+
+bool NavigationManager::isBuilt(const QString& screen) const {
+    auto it = m_pages.constFind(screen);
+    return it != m_pages.constEnd() && it->widget != nullptr;
+}
+
 void NavigationManager::navigateTo(const QString& screen) {
-    if (screen == "Home")
-        m_stack->setCurrentIndex(0);
-    else if (screen == "Options")
-        m_stack->setCurrentIndex(1);
-    else if (screen == "History")
-        m_stack->setCurrentIndex(2);
-    std::cout << "[NavigationManager] Navigated to " << screen.toStdString() << "\n";
+    auto it = m_pages.find(screen);
+    if (it != m_pages.end() && !it->widget) {
+        auto start = std::chrono::steady_clock::now();
+        it->widget = it->factory();
+        m_stack->addWidget(it->widget);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        Logger::instance().logf(LogChannel::Console, "[NavigationManager] Built %s page in %.1f ms",
+                                screen.toUtf8().constData(), ms);
+    }
+    if (it != m_pages.end())
+        m_stack->setCurrentWidget(it->widget);
+    Logger::instance().logf(LogChannel::Console, "[NavigationManager] Navigated to %s", screen.toUtf8().constData());
 }
 
 void NavigationManager::navigateToOptions() { navigateTo("Options"); }
@@ -3,21 +3,33 @@
 
 #include <QStackedWidget>
 #include <QString>
-#include <iostream>
+#include <QHash>
+#include <functional>
 
 //--------------------------------------------------------
 // NAVIGATION MANAGER (Navigation)
+// Pages are registered with a factory and only built the
+// first time they are navigated to.
 //--------------------------------------------------------
 class NavigationManager {
 public:
+    using PageFactory = std::function<QWidget*()>;
+
     NavigationManager(QStackedWidget* stack);
+    void registerPage(const QString& screen, PageFactory factory);
+    bool isBuilt(const QString& screen) const;
     void navigateTo(const QString& screen);
     void navigateToOptions();
     void navigateToHistory();
     void navigateToHome();
     void navigateToBolus();
 private:
+    struct Page {
+        PageFactory factory;
+        QWidget* widget = nullptr;
+    };
     QStackedWidget* m_stack;
+    QHash<QString, Page> m_pages;
 };
 
 #endif // NAVIGATIONMANAGER_H
@@ -0,0 +1,18 @@
+#include "pumpsnapshot.h"
+
+PumpSnapshot PumpSnapshot::capture(const Battery& battery,
+                                   const InsulinCartridge& cartridge,
+                                   const IOB& iob,
+                                   const CGMSensor& sensor) {
+    PumpSnapshot snapshot{};
+    snapshot.battery = battery.getStatus();
+    snapshot.insulin = cartridge.getInsulinLevel();
+    snapshot.iob = iob.getIOB();
+    snapshot.glucose = sensor.getGlucoseLevel();
+    snapshot.cgmConnected = sensor.isConnected();
+    snapshot.occluded = cartridge.isOccluded();
+    snapshot.basalState = BasalState::Stopped;
+    snapshot.basalRate = 0.0f;
+    snapshot.activeBoluses = 0;
+    return snapshot;
+}
@@ -0,0 +1,38 @@
+#ifndef PUMPSNAPSHOT_H
+#define PUMPSNAPSHOT_H
+
+#include "src/models/battery.h"
+#include "src/models/insulincartridge.h"
+#include "src/models/iob.h"
+#include "src/models/cgmsensor.h"
+
+enum class BasalState {
+    Stopped,
+    Running,
+    Paused
+};
+
+//--------------------------------------------------------
+// PUMP SNAPSHOT (what the UI shows)
+// Copied out of the models by the delivery thread after every
+// change and read by the UI through a SeqLock, so the screen
+// never sees a half-applied dose.
+//--------------------------------------------------------
+struct PumpSnapshot {
+    int battery;
+    int insulin;
+    float iob;
+    float glucose;
+    bool cgmConnected;
+    bool occluded;
+    BasalState basalState;
+    float basalRate;     // last delivered u/hr
+    int activeBoluses;   // extended boluses still delivering
+
+    static PumpSnapshot capture(const Battery& battery,
+                                const InsulinCartridge& cartridge,
+                                const IOB& iob,
+                                const CGMSensor& sensor);
+};
+
+#endif // PUMPSNAPSHOT_H
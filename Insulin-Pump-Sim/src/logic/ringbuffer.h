@@ -0,0 +1,42 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <cstddef>
+#include <vector>
+
+//--------------------------------------------------------
+// RING BUFFER
+// Fixed-capacity FIFO; pushing into a full buffer overwrites
+// the oldest element. Index 0 is the oldest element.
+//--------------------------------------------------------
+template <typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(std::size_t capacity)
+        : m_data(capacity > 0 ? capacity : 1), m_head(0), m_size(0) {}
+
+    void push(const T& value) {
+        m_data[(m_head + m_size) % m_data.size()] = value;
+        if (m_size < m_data.size())
+            m_size++;
+        else
+            m_head = (m_head + 1) % m_data.size();
+    }
+
+    const T& at(std::size_t index) const { return m_data[(m_head + index) % m_data.size()]; }
+    const T& front() const { return at(0); }
+    const T& back() const { return at(m_size - 1); }
+
+    std::size_t size() const { return m_size; }
+    std::size_t capacity() const { return m_data.size(); }
+    bool empty() const { return m_size == 0; }
+    bool full() const { return m_size == m_data.size(); }
+    void clear() { m_head = 0; m_size = 0; }
+
+private:
+    std::vector<T> m_data;
+    std::size_t m_head;
+    std::size_t m_size;
+};
+
+#endif // RINGBUFFER_H
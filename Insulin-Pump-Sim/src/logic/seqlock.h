@@ -0,0 +1,84 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+//--------------------------------------------------------
+// SEQLOCK (single writer, any number of readers)
+// The writer never waits: it bumps the sequence to odd,
+// copies the value in, and bumps it back to even. A reader
+// copies the value out and retries if the sequence moved,
+// so it only spins while a write is actually in progress.
+// The value is held as relaxed atomic words, which keeps a
+// torn read well-defined (it is detected and discarded).
+//--------------------------------------------------------
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock needs a trivially copyable type");
+
+public:
+    SeqLock() : m_sequence(0) {
+        for (auto& word : m_words)
+            word.store(0, std::memory_order_relaxed);
+    }
+
+    // Writer thread only
+    void store(const T& value) {
+        std::uint64_t words[kWords] = {};
+        std::memcpy(words, &value, sizeof(T));
+        std::uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < kWords; i++)
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    T load() const {
+        std::uint64_t words[kWords];
+        for (;;) {
+            std::uint32_t before = m_sequence.load(std::memory_order_acquire);
+            if (before & 1u)
+                continue;
+            for (std::size_t i = 0; i < kWords; i++)
+                words[i] = m_words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_sequence.load(std::memory_order_relaxed) == before)
+                break;
+        }
+        T value;
+        std::memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+    // One attempt; false while a write is in progress or if one raced the copy
+    bool tryLoad(T& value) const {
+        std::uint64_t words[kWords];
+        std::uint32_t before = m_sequence.load(std::memory_order_acquire);
+        if (before & 1u)
+            return false;
+        for (std::size_t i = 0; i < kWords; i++)
+            words[i] = m_words[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_sequence.load(std::memory_order_relaxed) != before)
+            return false;
+        std::memcpy(&value, words, sizeof(T));
+        return true;
+    }
+
+    // Number of completed writes
+    std::uint32_t version() const { return m_sequence.load(std::memory_order_acquire) / 2; }
+
+private:
+    static constexpr std::size_t kWords = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+    std::atomic<std::uint32_t> m_sequence;
+    std::array<std::atomic<std::uint64_t>, kWords> m_words;
+};
+
+#endif // SEQLOCK_H
@@ -0,0 +1,24 @@
+#include "simclock.h"
+
+SimClock::SimClock(std::int64_t startMs) : m_nowMs(startMs) {}
+
+std::int64_t SimClock::nowMs() const {
+    return m_nowMs;
+}
+
+void SimClock::advance(std::int64_t simMs) {
+    if (simMs > 0)
+        m_nowMs += simMs;
+}
+
+void SimClock::tick() {
+    m_nowMs += kTickSimMs;
+}
+
+std::int64_t SimClock::toSimulated(std::int64_t realMs) {
+    return realMs * kSpeedup;
+}
+
+std::int64_t SimClock::toReal(std::int64_t simMs) {
+    return simMs / kSpeedup;
+}
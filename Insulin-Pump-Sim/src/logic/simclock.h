@@ -0,0 +1,31 @@
+#ifndef SIMCLOCK_H
+#define SIMCLOCK_H
+
+#include <cstdint>
+
+//--------------------------------------------------------
+// SIM CLOCK (simulated pump time)
+// The simulator runs 360x real time: one 10 s delivery tick
+// in the GUI stands for one hour on the pump. Batch runs
+// advance the clock directly without waiting.
+//--------------------------------------------------------
+class SimClock {
+public:
+    static constexpr std::int64_t kTickRealMs = 10 * 1000;        // GUI timer period
+    static constexpr std::int64_t kTickSimMs = 60 * 60 * 1000;    // one simulated hour
+    static constexpr std::int64_t kSpeedup = kTickSimMs / kTickRealMs;
+
+    explicit SimClock(std::int64_t startMs = 0);
+
+    std::int64_t nowMs() const;
+    void advance(std::int64_t simMs);
+    void tick();  // one delivery tick
+
+    static std::int64_t toSimulated(std::int64_t realMs);
+    static std::int64_t toReal(std::int64_t simMs);
+
+private:
+    std::int64_t m_nowMs;
+};
+
+#endif // SIMCLOCK_H
@@ -0,0 +1,63 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+//--------------------------------------------------------
+// SPSC RING (lock-free, one producer thread, one consumer)
+// Fixed power-of-two capacity, never allocates. Head and
+// tail sit on separate cache lines, and each side caches the
+// other side's index so the shared line is only read when
+// the ring looks full (producer) or empty (consumer). A push
+// into a full ring fails instead of overwriting.
+//--------------------------------------------------------
+template <typename T, std::size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    // Producer thread only
+    bool tryPush(const T& value) {
+        std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_headCache == Capacity) {
+            m_headCache = m_head.load(std::memory_order_acquire);
+            if (tail - m_headCache == Capacity)
+                return false;
+        }
+        m_slots[tail & kMask] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only
+    bool tryPop(T& value) {
+        std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tailCache) {
+            m_tailCache = m_tail.load(std::memory_order_acquire);
+            if (head == m_tailCache)
+                return false;
+        }
+        value = m_slots[head & kMask];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Either thread; exact only when the other side is idle
+    std::size_t sizeApprox() const {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+    static constexpr std::size_t capacity() { return Capacity; }
+
+private:
+    static constexpr std::size_t kMask = Capacity - 1;
+
+    alignas(64) std::atomic<std::size_t> m_head{0};
+    std::size_t m_tailCache = 0;    // consumer's last view of m_tail
+    alignas(64) std::atomic<std::size_t> m_tail{0};
+    std::size_t m_headCache = 0;    // producer's last view of m_head
+    alignas(64) std::array<T, Capacity> m_slots{};
+};
+
+#endif // SPSCRING_H
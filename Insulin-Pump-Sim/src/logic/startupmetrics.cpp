@@ -0,0 +1,59 @@
+#include "startupmetrics.h"
+#include "logger.h"
+#include <cstdio>
+
+StartupMetrics::StartupMetrics()
+    : m_start(Clock::now()), m_last(m_start), m_finished(false)
+{}
+
+StartupMetrics& StartupMetrics::instance() {
+    static StartupMetrics metrics;
+    return metrics;
+}
+
+void StartupMetrics::begin() {
+    m_start = Clock::now();
+    m_last = m_start;
+    m_phases.clear();
+    m_finished = false;
+}
+
+void StartupMetrics::mark(const char* phase) {
+    if (m_finished)
+        return;
+    Clock::time_point now = Clock::now();
+    m_phases.push_back({phase, std::chrono::duration<double, std::milli>(now - m_last).count()});
+    m_last = now;
+}
+
+void StartupMetrics::finish(const char* phase) {
+    if (m_finished)
+        return;
+    mark(phase);
+    m_finished = true;
+    Logger::instance().logf(LogChannel::Console, "%s", summary().c_str());
+}
+
+bool StartupMetrics::finished() const {
+    return m_finished;
+}
+
+double StartupMetrics::totalMs() const {
+    return std::chrono::duration<double, std::milli>(m_last - m_start).count();
+}
+
+const std::vector<StartupMetrics::Phase>& StartupMetrics::phases() const {
+    return m_phases;
+}
+
+// "[STARTUP] total 84.2 ms | qapplication 31.0 | main window 12.5 | ..."
+std::string StartupMetrics::summary() const {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "[STARTUP] total %.1f ms", totalMs());
+    std::string text = buffer;
+    for (const Phase& phase : m_phases) {
+        std::snprintf(buffer, sizeof(buffer), " | %s %.1f", phase.name.c_str(), phase.ms);
+        text += buffer;
+    }
+    return text;
+}
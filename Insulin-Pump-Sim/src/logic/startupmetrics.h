@@ -0,0 +1,43 @@
+#ifndef STARTUPMETRICS_H
+#define STARTUPMETRICS_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+//--------------------------------------------------------
+// STARTUP METRICS (cold-start timing)
+// begin() is the first thing main() does; every mark() ends
+// a phase. finish() closes the last phase (first paint) and
+// logs one "[STARTUP]" line with the per-phase breakdown.
+//--------------------------------------------------------
+class StartupMetrics {
+public:
+    struct Phase {
+        std::string name;
+        double ms;
+    };
+
+    static StartupMetrics& instance();
+
+    void begin();
+    void mark(const char* phase);
+    // Only the first call does anything
+    void finish(const char* phase);
+
+    bool finished() const;
+    double totalMs() const;
+    const std::vector<Phase>& phases() const;
+    std::string summary() const;
+
+private:
+    StartupMetrics();
+
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point m_start;
+    Clock::time_point m_last;
+    std::vector<Phase> m_phases;
+    bool m_finished;
+};
+
+#endif // STARTUPMETRICS_H
@@ -0,0 +1,147 @@
+#include "telemetryfeed.h"
+#include <cstring>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TELEMETRY_POSIX 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr char kMagic[8] = {'P', 'U', 'M', 'P', 'T', 'E', 'L', 'E'};
+}
+
+static_assert(sizeof(TelemetryState) == 40, "telemetry state layout");
+
+TelemetryState TelemetryState::from(const PumpSnapshot& snapshot, std::int64_t publishedMs) {
+    TelemetryState state{};
+    state.publishedMs = publishedMs;
+    state.battery = snapshot.battery;
+    state.insulin = snapshot.insulin;
+    state.iob = snapshot.iob;
+    state.glucose = snapshot.glucose;
+    state.basalRate = snapshot.basalRate;
+    state.activeBoluses = static_cast<std::uint32_t>(snapshot.activeBoluses);
+    state.cgmConnected = snapshot.cgmConnected ? 1 : 0;
+    state.occluded = snapshot.occluded ? 1 : 0;
+    state.basalState = static_cast<std::uint8_t>(snapshot.basalState);
+    return state;
+}
+
+TelemetryFeed::TelemetryFeed()
+    : m_page(nullptr)
+{}
+
+TelemetryFeed::~TelemetryFeed() {
+    close();
+}
+
+bool TelemetryFeed::open(const std::string& name) {
+    close();
+#ifdef TELEMETRY_POSIX
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0)
+        return false;
+    if (ftruncate(fd, sizeof(TelemetryPage)) != 0) {
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* memory = mmap(nullptr, sizeof(TelemetryPage), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        return false;
+    }
+    // Readers ignore the page until the magic appears
+    std::memset(memory, 0, sizeof(TelemetryPage));
+    m_page = new (memory) TelemetryPage;
+    m_page->layoutVersion = TelemetryPage::kLayoutVersion;
+    m_page->stateSize = sizeof(TelemetryState);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(m_page->magic, kMagic, sizeof(kMagic));
+    m_name = name;
+    return true;
+#else
+    (void)name;
+    return false;
+#endif
+}
+
+void TelemetryFeed::close() {
+#ifdef TELEMETRY_POSIX
+    if (!m_page)
+        return;
+    munmap(m_page, sizeof(TelemetryPage));
+    shm_unlink(m_name.c_str());
+#endif
+    m_page = nullptr;
+    m_name.clear();
+}
+
+bool TelemetryFeed::isOpen() const {
+    return m_page != nullptr;
+}
+
+void TelemetryFeed::publish(const TelemetryState& state) {
+    if (m_page)
+        m_page->state.store(state);
+}
+
+TelemetryReader::TelemetryReader()
+    : m_page(nullptr)
+{}
+
+TelemetryReader::~TelemetryReader() {
+    close();
+}
+
+bool TelemetryReader::open(const std::string& name) {
+    close();
+#ifdef TELEMETRY_POSIX
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+        return false;
+    void* memory = mmap(nullptr, sizeof(TelemetryPage), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED)
+        return false;
+    const TelemetryPage* page = static_cast<const TelemetryPage*>(memory);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (std::memcmp(page->magic, kMagic, sizeof(kMagic)) != 0
+        || page->layoutVersion != TelemetryPage::kLayoutVersion
+        || page->stateSize != sizeof(TelemetryState)) {
+        munmap(memory, sizeof(TelemetryPage));
+        return false;
+    }
+    m_page = page;
+    return true;
+#else
+    (void)name;
+    return false;
+#endif
+}
+
+void TelemetryReader::close() {
+#ifdef TELEMETRY_POSIX
+    if (m_page)
+        munmap(const_cast<TelemetryPage*>(m_page), sizeof(TelemetryPage));
+#endif
+    m_page = nullptr;
+}
+
+bool TelemetryReader::sample(TelemetryState& state, int attempts) const {
+    if (!m_page)
+        return false;
+    for (int i = 0; i < attempts; i++) {
+        if (m_page->state.tryLoad(state))
+            return true;
+    }
+    return false;
+}
+
+std::uint32_t TelemetryReader::sequence() const {
+    return m_page ? m_page->state.version() : 0;
+}
@@ -0,0 +1,82 @@
+#ifndef TELEMETRYFEED_H
+#define TELEMETRYFEED_H
+
+#include <cstdint>
+#include <string>
+#include "pumpsnapshot.h"
+#include "seqlock.h"
+
+// Fixed-width copy of PumpSnapshot for readers in other processes
+struct TelemetryState {
+    std::int64_t publishedMs;   // steady clock of the publisher
+    std::int32_t battery;
+    std::int32_t insulin;
+    float iob;
+    float glucose;
+    float basalRate;
+    std::uint32_t activeBoluses;
+    std::uint8_t cgmConnected;
+    std::uint8_t occluded;
+    std::uint8_t basalState;    // BasalState
+    std::uint8_t reserved[5];
+
+    static TelemetryState from(const PumpSnapshot& snapshot, std::int64_t publishedMs);
+};
+
+// Shared memory layout: header, then the SeqLock-protected state
+struct TelemetryPage {
+    static constexpr std::uint32_t kLayoutVersion = 1;
+
+    char magic[8];              // "PUMPTELE", written last
+    std::uint32_t layoutVersion;
+    std::uint32_t stateSize;
+    SeqLock<TelemetryState> state;
+};
+
+//--------------------------------------------------------
+// TELEMETRY FEED (live state in POSIX shared memory)
+// The publisher maps one page and stores each snapshot into
+// its SeqLock: no syscalls and no waiting on readers. Readers
+// map the page read-only and sample it as often as they like;
+// a write in progress just means another try. The sequence
+// (SeqLock::version) tells a reader whether anything changed.
+// Readers check the magic, layout version and state size
+// before trusting the page. Unsupported platforms open nothing.
+//--------------------------------------------------------
+class TelemetryFeed {
+public:
+    TelemetryFeed();
+    ~TelemetryFeed();
+
+    // Create (or take over) the segment, e.g. "/insulinpump-telemetry"
+    bool open(const std::string& name);
+    // Unmap and remove the segment
+    void close();
+    bool isOpen() const;
+
+    // Publisher thread only
+    void publish(const TelemetryState& state);
+
+private:
+    TelemetryPage* m_page;
+    std::string m_name;
+};
+
+class TelemetryReader {
+public:
+    TelemetryReader();
+    ~TelemetryReader();
+
+    bool open(const std::string& name);
+    void close();
+
+    // Latest state; false if the publisher was mid-write every try
+    bool sample(TelemetryState& state, int attempts = 64) const;
+    // Completed publishes so far
+    std::uint32_t sequence() const;
+
+private:
+    const TelemetryPage* m_page;
+};
+
+#endif // TELEMETRYFEED_H
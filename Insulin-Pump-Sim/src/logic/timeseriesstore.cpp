@@ -0,0 +1,262 @@
+#include "timeseriesstore.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+int leadingZeros(std::uint64_t x) {
+    return x ? __builtin_clzll(x) : 64;
+}
+
+int trailingZeros(std::uint64_t x) {
+    return x ? __builtin_ctzll(x) : 64;
+}
+}
+
+TimeSeries::TimeSeries(double quantum)
+    : m_size(0), m_quantum(quantum), m_prevMs(0), m_prevDelta(0), m_prevBits(0), m_prevLeading(-1),
+    m_prevTrailing(0), m_prevSteps(0)
+{}
+
+void TimeSeries::append(std::int64_t timestampMs, double value) {
+    if (m_size > 0 && timestampMs < m_prevMs)
+        timestampMs = m_prevMs;
+    // Summaries hold the value that decodes back out
+    if (m_quantum > 0.0)
+        value = std::llround(value / m_quantum) * m_quantum;
+
+    if (m_blocks.empty() || m_blocks.back().count == kSamplesPerBlock) {
+        m_blocks.emplace_back();
+        // Rough guess at a full block so appends rarely reallocate
+        m_blocks.back().words.reserve(kSamplesPerBlock / 16);
+    }
+
+    Block& block = m_blocks.back();
+    encode(block, timestampMs, value);
+
+    if (block.count == 0) {
+        block.firstMs = timestampMs;
+        block.min = value;
+        block.max = value;
+    } else {
+        block.min = std::min(block.min, value);
+        block.max = std::max(block.max, value);
+    }
+    block.lastMs = timestampMs;
+    block.sum += value;
+    block.count++;
+    m_size++;
+}
+
+void TimeSeries::writeBits(Block& block, std::uint64_t value, int bits) {
+    if (bits < 64)
+        value &= (std::uint64_t(1) << bits) - 1;
+    int used = static_cast<int>(block.bitCount & 63);
+    if (used == 0)
+        block.words.push_back(0);
+    int free = 64 - used;
+    if (bits <= free) {
+        block.words.back() |= value << (free - bits);
+    } else {
+        int rest = bits - free;
+        block.words.back() |= value >> rest;
+        block.words.push_back(value << (64 - rest));
+    }
+    block.bitCount += bits;
+}
+
+void TimeSeries::encode(Block& block, std::int64_t timestampMs, double value) {
+    std::uint64_t bits;
+    std::int64_t steps = 0;
+    if (m_quantum > 0.0) {
+        steps = std::llround(value / m_quantum);
+        bits = static_cast<std::uint64_t>(steps);
+    } else {
+        std::memcpy(&bits, &value, sizeof(bits));
+    }
+
+    // First sample of a block is stored raw so every block decodes on its own
+    if (block.count == 0) {
+        writeBits(block, static_cast<std::uint64_t>(timestampMs), 64);
+        writeBits(block, bits, 64);
+        m_prevMs = timestampMs;
+        m_prevDelta = 0;
+        m_prevBits = bits;
+        m_prevLeading = -1;
+        m_prevTrailing = 0;
+        m_prevSteps = steps;
+        return;
+    }
+
+    std::int64_t delta = timestampMs - m_prevMs;
+    std::int64_t dod = delta - m_prevDelta;
+    if (dod == 0) {
+        writeBits(block, 0b0, 1);
+    } else if (dod >= -63 && dod <= 64) {
+        writeBits(block, 0b10, 2);
+        writeBits(block, static_cast<std::uint64_t>(dod + 63), 7);
+    } else if (dod >= -255 && dod <= 256) {
+        writeBits(block, 0b110, 3);
+        writeBits(block, static_cast<std::uint64_t>(dod + 255), 9);
+    } else if (dod >= -2047 && dod <= 2048) {
+        writeBits(block, 0b1110, 4);
+        writeBits(block, static_cast<std::uint64_t>(dod + 2047), 12);
+    } else {
+        writeBits(block, 0b1111, 4);
+        writeBits(block, static_cast<std::uint64_t>(dod), 64);
+    }
+    m_prevDelta = delta;
+    m_prevMs = timestampMs;
+
+    if (m_quantum > 0.0) {
+        std::int64_t change = steps - m_prevSteps;
+        m_prevSteps = steps;
+        if (change == 0) {
+            writeBits(block, 0b0, 1);
+        } else if (change >= -2 && change <= 2) {
+            writeBits(block, 0b10, 2);
+            writeBits(block, static_cast<std::uint64_t>(change < 0 ? change + 2 : change + 1), 2);
+        } else if (change >= -64 && change <= 63) {
+            writeBits(block, 0b110, 3);
+            writeBits(block, static_cast<std::uint64_t>(change + 64), 7);
+        } else {
+            writeBits(block, 0b111, 3);
+            writeBits(block, static_cast<std::uint64_t>(change), 64);
+        }
+        return;
+    }
+
+    std::uint64_t x = bits ^ m_prevBits;
+    m_prevBits = bits;
+    if (x == 0) {
+        writeBits(block, 0b0, 1);
+        return;
+    }
+    int leading = std::min(leadingZeros(x), 31);
+    int trailing = trailingZeros(x);
+    if (m_prevLeading >= 0 && leading >= m_prevLeading && trailing >= m_prevTrailing) {
+        // Meaningful bits fit inside the previous window
+        writeBits(block, 0b10, 2);
+        writeBits(block, x >> m_prevTrailing, 64 - m_prevLeading - m_prevTrailing);
+    } else {
+        int meaningful = 64 - leading - trailing;
+        writeBits(block, 0b11, 2);
+        writeBits(block, static_cast<std::uint64_t>(leading), 5);
+        writeBits(block, static_cast<std::uint64_t>(meaningful == 64 ? 0 : meaningful), 6);
+        writeBits(block, x >> trailing, meaningful);
+        m_prevLeading = leading;
+        m_prevTrailing = trailing;
+    }
+}
+
+std::size_t TimeSeries::size() const {
+    return m_size;
+}
+
+std::size_t TimeSeries::compressedBytes() const {
+    std::size_t bytes = 0;
+    for (const Block& block : m_blocks)
+        bytes += (block.bitCount + 7) / 8;
+    return bytes;
+}
+
+double TimeSeries::bytesPerSample() const {
+    return m_size ? static_cast<double>(compressedBytes()) / m_size : 0.0;
+}
+
+std::int64_t TimeSeries::firstTimestamp() const {
+    return m_blocks.empty() ? 0 : m_blocks.front().firstMs;
+}
+
+std::int64_t TimeSeries::lastTimestamp() const {
+    return m_blocks.empty() ? 0 : m_blocks.back().lastMs;
+}
+
+double TimeSeries::quantum() const {
+    return m_quantum;
+}
+
+void TimeSeries::dropBefore(std::int64_t cutoffMs) {
+    while (!m_blocks.empty() && m_blocks.front().lastMs < cutoffMs
+           && m_blocks.front().count == kSamplesPerBlock) {
+        m_size -= m_blocks.front().count;
+        m_blocks.pop_front();
+    }
+}
+
+TimeSeriesAggregate TimeSeries::aggregate(std::int64_t fromMs, std::int64_t toMs) const {
+    TimeSeriesAggregate agg;
+    auto add = [&agg](double v) {
+        if (agg.count == 0) {
+            agg.min = v;
+            agg.max = v;
+        } else {
+            agg.min = std::min(agg.min, v);
+            agg.max = std::max(agg.max, v);
+        }
+        agg.sum += v;
+        agg.count++;
+    };
+
+    for (const Block& block : m_blocks) {
+        if (block.lastMs < fromMs)
+            continue;
+        if (block.firstMs > toMs)
+            break;
+        if (block.firstMs >= fromMs && block.lastMs <= toMs) {
+            // Whole block inside the range: use its summary, no decoding
+            if (agg.count == 0) {
+                agg.min = block.min;
+                agg.max = block.max;
+            } else {
+                agg.min = std::min(agg.min, block.min);
+                agg.max = std::max(agg.max, block.max);
+            }
+            agg.sum += block.sum;
+            agg.count += block.count;
+        } else {
+            decode(block, [&](std::int64_t ts, double v) {
+                if (ts >= fromMs && ts <= toMs)
+                    add(v);
+            });
+        }
+    }
+    return agg;
+}
+
+std::vector<TimeSeriesSample> TimeSeries::read(std::int64_t fromMs, std::int64_t toMs) const {
+    std::vector<TimeSeriesSample> out;
+    scan(fromMs, toMs, [&out](std::int64_t ts, double v) {
+        out.push_back({ts, v});
+    });
+    return out;
+}
+
+TimeSeriesStore::TimeSeriesStore(std::int64_t retentionMs)
+    : m_series{TimeSeries(0.1), TimeSeries(0.01), TimeSeries(1.0), TimeSeries(1.0)},
+    m_retentionMs(retentionMs)
+{}
+
+void TimeSeriesStore::record(PumpChannel channel, std::int64_t timestampMs, double value) {
+    TimeSeries& series = m_series[static_cast<int>(channel)];
+    series.append(timestampMs, value);
+    if (m_retentionMs > 0 && series.firstTimestamp() < timestampMs - m_retentionMs)
+        series.dropBefore(timestampMs - m_retentionMs);
+}
+
+void TimeSeriesStore::recordAll(std::int64_t timestampMs, double cgm, double iob, double cartridge, double battery) {
+    record(PumpChannel::Cgm, timestampMs, cgm);
+    record(PumpChannel::Iob, timestampMs, iob);
+    record(PumpChannel::Cartridge, timestampMs, cartridge);
+    record(PumpChannel::Battery, timestampMs, battery);
+}
+
+const TimeSeries& TimeSeriesStore::series(PumpChannel channel) const {
+    return m_series[static_cast<int>(channel)];
+}
+
+std::size_t TimeSeriesStore::compressedBytes() const {
+    std::size_t bytes = 0;
+    for (const TimeSeries& s : m_series)
+        bytes += s.compressedBytes();
+    return bytes;
+}
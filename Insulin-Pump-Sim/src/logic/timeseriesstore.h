@@ -0,0 +1,242 @@
+#ifndef TIMESERIESSTORE_H
+#define TIMESERIESSTORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+//--------------------------------------------------------
+// TIME SERIES STORE (long-term trend history)
+// Gorilla-style compression: delta-of-delta timestamps and
+// XOR'd doubles, packed MSB-first into fixed-size blocks of
+// kSamplesPerBlock samples. Every block carries a min/max/sum
+// summary so range aggregates only decode the partial blocks
+// at either end of the range. A series with a quantum (0.1
+// mmol/L for CGM) rounds values to whole steps and stores the
+// step deltas instead of the XOR: a 5-minute CGM stream then
+// takes well under a byte per sample, where XOR'd sensor
+// noise needs several.
+//--------------------------------------------------------
+struct TimeSeriesSample {
+    std::int64_t timestampMs;
+    double value;
+};
+
+struct TimeSeriesAggregate {
+    std::size_t count = 0;
+    double min = 0.0;
+    double max = 0.0;
+    double sum = 0.0;
+    double mean() const { return count ? sum / count : 0.0; }
+};
+
+class TimeSeries {
+public:
+    static constexpr std::size_t kSamplesPerBlock = 1024;
+
+    // quantum 0 keeps exact doubles
+    explicit TimeSeries(double quantum = 0.0);
+
+    // Timestamps must not go backwards; an older timestamp is clamped to the last one.
+    void append(std::int64_t timestampMs, double value);
+
+    std::size_t size() const;
+    std::size_t compressedBytes() const;
+    double bytesPerSample() const;
+    std::int64_t firstTimestamp() const;
+    std::int64_t lastTimestamp() const;
+    double quantum() const;
+
+    // Drop whole blocks that end before the cutoff
+    void dropBefore(std::int64_t cutoffMs);
+
+    // min/max/sum/count over [fromMs, toMs]
+    TimeSeriesAggregate aggregate(std::int64_t fromMs, std::int64_t toMs) const;
+    // Decoded samples in [fromMs, toMs]
+    std::vector<TimeSeriesSample> read(std::int64_t fromMs, std::int64_t toMs) const;
+
+    // Calls fn(timestampMs, value) for every sample in [fromMs, toMs]
+    template <typename Fn>
+    void scan(std::int64_t fromMs, std::int64_t toMs, Fn&& fn) const;
+
+private:
+    struct Block {
+        std::vector<std::uint64_t> words;
+        std::size_t bitCount = 0;
+        std::size_t count = 0;
+        std::int64_t firstMs = 0;
+        std::int64_t lastMs = 0;
+        double min = 0.0;
+        double max = 0.0;
+        double sum = 0.0;
+    };
+
+    class BitReader {
+    public:
+        explicit BitReader(const std::vector<std::uint64_t>& words) : m_words(words.data()), m_pos(0) {}
+        std::uint64_t readBit();
+        std::uint64_t read(int bits);
+    private:
+        const std::uint64_t* m_words;
+        std::size_t m_pos;
+    };
+
+    static void writeBits(Block& block, std::uint64_t value, int bits);
+    void encode(Block& block, std::int64_t timestampMs, double value);
+
+    template <typename Fn>
+    void decode(const Block& block, Fn&& fn) const;
+
+    std::deque<Block> m_blocks;
+    std::size_t m_size;
+    double m_quantum;
+    // Encoder state for the open (last) block
+    std::int64_t m_prevMs;
+    std::int64_t m_prevDelta;
+    std::uint64_t m_prevBits;
+    int m_prevLeading;
+    int m_prevTrailing;
+    std::int64_t m_prevSteps;   // quantized series
+};
+
+//--------------------------------------------------------
+// Pump channels kept for trend views
+//--------------------------------------------------------
+enum class PumpChannel {
+    Cgm,
+    Iob,
+    Cartridge,
+    Battery,
+    Count
+};
+
+class TimeSeriesStore {
+public:
+    // Six months by default
+    explicit TimeSeriesStore(std::int64_t retentionMs = 183LL * 24 * 60 * 60 * 1000);
+
+    void record(PumpChannel channel, std::int64_t timestampMs, double value);
+    // Convenience: one sample on every channel at the same instant
+    void recordAll(std::int64_t timestampMs, double cgm, double iob, double cartridge, double battery);
+
+    const TimeSeries& series(PumpChannel channel) const;
+    std::size_t compressedBytes() const;
+
+private:
+    TimeSeries m_series[static_cast<int>(PumpChannel::Count)];  // CGM 0.1 mmol/L, IOB 0.01 u, 1 u, 1%
+    std::int64_t m_retentionMs;
+};
+
+//--------------------------------------------------------
+// Template implementations
+//--------------------------------------------------------
+inline std::uint64_t TimeSeries::BitReader::readBit() {
+    std::uint64_t bit = (m_words[m_pos >> 6] >> (63 - (m_pos & 63))) & 1u;
+    m_pos++;
+    return bit;
+}
+
+inline std::uint64_t TimeSeries::BitReader::read(int bits) {
+    std::size_t index = m_pos >> 6;
+    int used = static_cast<int>(m_pos & 63);
+    int available = 64 - used;
+    std::uint64_t word = m_words[index] << used;
+    std::uint64_t result;
+    if (bits <= available) {
+        result = word >> (64 - bits);
+    } else {
+        int rest = bits - available;
+        result = (word >> (64 - bits)) | (m_words[index + 1] >> (64 - rest));
+    }
+    m_pos += bits;
+    return result;
+}
+
+template <typename Fn>
+void TimeSeries::decode(const Block& block, Fn&& fn) const {
+    if (block.count == 0)
+        return;
+    BitReader in(block.words);
+    std::int64_t ts = static_cast<std::int64_t>(in.read(64));
+    std::uint64_t bits = in.read(64);
+    std::int64_t delta = 0;
+    int leading = 0;
+    int trailing = 0;
+
+    double value;
+    static_assert(sizeof(value) == sizeof(bits), "double must be 64-bit");
+    std::int64_t steps = static_cast<std::int64_t>(bits);
+    if (m_quantum > 0.0)
+        value = steps * m_quantum;
+    else
+        std::memcpy(&value, &bits, sizeof(value));
+    fn(ts, value);
+
+    for (std::size_t i = 1; i < block.count; i++) {
+        // Timestamp: delta-of-delta with variable-width buckets
+        std::int64_t dod;
+        if (!in.readBit()) {
+            dod = 0;
+        } else if (!in.readBit()) {
+            dod = static_cast<std::int64_t>(in.read(7)) - 63;
+        } else if (!in.readBit()) {
+            dod = static_cast<std::int64_t>(in.read(9)) - 255;
+        } else if (!in.readBit()) {
+            dod = static_cast<std::int64_t>(in.read(12)) - 2047;
+        } else {
+            dod = static_cast<std::int64_t>(in.read(64));
+        }
+        delta += dod;
+        ts += delta;
+
+        if (m_quantum > 0.0) {
+            // Value: step delta, 0 / +-2 / 7-bit / raw buckets
+            if (in.readBit()) {
+                if (!in.readBit()) {
+                    std::int64_t code = static_cast<std::int64_t>(in.read(2));
+                    steps += code < 2 ? code - 2 : code - 1;
+                } else if (!in.readBit()) {
+                    steps += static_cast<std::int64_t>(in.read(7)) - 64;
+                } else {
+                    steps += static_cast<std::int64_t>(in.read(64));
+                }
+                value = steps * m_quantum;
+            }
+            fn(ts, value);
+            continue;
+        }
+
+        // Value: XOR against the previous value
+        if (in.readBit()) {
+            if (in.readBit()) {
+                leading = static_cast<int>(in.read(5));
+                int meaningful = static_cast<int>(in.read(6));
+                if (meaningful == 0)
+                    meaningful = 64;
+                trailing = 64 - leading - meaningful;
+            }
+            int meaningful = 64 - leading - trailing;
+            bits ^= in.read(meaningful) << trailing;
+            std::memcpy(&value, &bits, sizeof(value));
+        }
+        fn(ts, value);
+    }
+}
+
+template <typename Fn>
+void TimeSeries::scan(std::int64_t fromMs, std::int64_t toMs, Fn&& fn) const {
+    for (const Block& block : m_blocks) {
+        if (block.lastMs < fromMs)
+            continue;
+        if (block.firstMs > toMs)
+            break;
+        decode(block, [&](std::int64_t ts, double v) {
+            if (ts >= fromMs && ts <= toMs)
+                fn(ts, v);
+        });
+    }
+}
+
+#endif // TIMESERIESSTORE_H
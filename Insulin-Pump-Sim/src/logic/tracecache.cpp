@@ -0,0 +1,266 @@
+#include "tracecache.h"
+#include "cgmimport.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TRACECACHE_POSIX 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr char kMagic[8] = {'P', 'U', 'M', 'P', 'T', 'R', 'C', 'E'};
+
+std::uint64_t alignUp(std::uint64_t value) {
+    return (value + TraceCache::kAlignment - 1) & ~static_cast<std::uint64_t>(TraceCache::kAlignment - 1);
+}
+
+#ifdef TRACECACHE_POSIX
+bool statSource(const std::string& path, std::uint64_t& size, std::int64_t& mtimeNs) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0)
+        return false;
+    size = static_cast<std::uint64_t>(info.st_size);
+#if defined(__APPLE__)
+    mtimeNs = static_cast<std::int64_t>(info.st_mtimespec.tv_sec) * 1000000000LL + info.st_mtimespec.tv_nsec;
+#else
+    mtimeNs = static_cast<std::int64_t>(info.st_mtim.tv_sec) * 1000000000LL + info.st_mtim.tv_nsec;
+#endif
+    return true;
+}
+#endif
+}
+
+TraceCache::TraceCache()
+    : m_image(nullptr),
+    m_imageSize(0),
+    m_header(nullptr),
+    m_rebuilt(false)
+{
+    static_assert(sizeof(Header) == 128, "trace header layout");
+}
+
+TraceCache::~TraceCache() {
+    close();
+}
+
+std::string TraceCache::cachePathFor(const std::string& sourcePath) {
+    return sourcePath + ".trace";
+}
+
+bool TraceCache::load(const std::string& sourcePath) {
+    std::string cachePath = cachePathFor(sourcePath);
+    m_rebuilt = false;
+    if (open(cachePath) && isFresh(sourcePath))
+        return true;
+    close();
+    if (!build(sourcePath, cachePath))
+        return false;
+    m_rebuilt = true;
+    return open(cachePath);
+}
+
+bool TraceCache::open(const std::string& cachePath) {
+    close();
+#ifdef TRACECACHE_POSIX
+    int fd = ::open(cachePath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(Header)) {
+        ::close(fd);
+        return false;
+    }
+    std::size_t size = static_cast<std::size_t>(info.st_size);
+    void* memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED)
+        return false;
+
+    const Header* header = static_cast<const Header*>(memory);
+    bool valid = std::memcmp(header->magic, kMagic, sizeof(kMagic)) == 0
+                 && header->version == kVersion
+                 && header->headerSize == sizeof(Header)
+                 && header->fileSize == size;
+    if (valid) {
+        Header expected{};
+        layout(expected, header->rows);
+        valid = expected.fileSize == size
+                && std::memcmp(expected.columnOffset, header->columnOffset, sizeof(expected.columnOffset)) == 0;
+    }
+    if (!valid) {
+        munmap(memory, size);
+        return false;
+    }
+    m_image = static_cast<const unsigned char*>(memory);
+    m_imageSize = size;
+    m_header = header;
+    return true;
+#else
+    (void)cachePath;
+    return false;
+#endif
+}
+
+void TraceCache::close() {
+#ifdef TRACECACHE_POSIX
+    if (m_image)
+        munmap(const_cast<unsigned char*>(m_image), m_imageSize);
+#endif
+    m_image = nullptr;
+    m_imageSize = 0;
+    m_header = nullptr;
+}
+
+bool TraceCache::build(const std::string& sourcePath, const std::string& cachePath) {
+#ifdef TRACECACHE_POSIX
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.headerSize = sizeof(Header);
+    if (!statSource(sourcePath, header.sourceSize, header.sourceMtimeNs))
+        return false;
+
+    // Pass 1: count rows and note which way the timestamps run
+    CgmImportReader reader;
+    if (!reader.open(sourcePath))
+        return false;
+    CgmReading reading;
+    std::uint64_t rows = 0;
+    std::int64_t previous = 0;
+    bool ascending = true;
+    bool descending = true;     // Nightscout exports are newest first
+    while (reader.next(reading)) {
+        if (rows > 0) {
+            ascending = ascending && reading.timestampMs >= previous;
+            descending = descending && reading.timestampMs <= previous;
+        }
+        previous = reading.timestampMs;
+        rows++;
+    }
+    layout(header, rows);
+
+    // Pass 2: write each row into its column slots in the mapped file
+    std::string tempPath = cachePath + ".tmp";
+    int fd = ::open(tempPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return false;
+    if (ftruncate(fd, static_cast<off_t>(header.fileSize)) != 0) {
+        ::close(fd);
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    void* memory = mmap(nullptr, header.fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (memory == MAP_FAILED) {
+        ::close(fd);
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    unsigned char* image = static_cast<unsigned char*>(memory);
+    std::int64_t* timestamps = reinterpret_cast<std::int64_t*>(image + header.columnOffset[Timestamps]);
+    float* glucose = reinterpret_cast<float*>(image + header.columnOffset[Glucose]);
+
+    // Rows are stored oldest first; a descending file is written back to front
+    bool reverse = !ascending && descending;
+    bool ok = reader.open(sourcePath);
+    std::uint64_t row = 0;
+    while (ok && row < rows && reader.next(reading)) {
+        std::uint64_t slot = reverse ? rows - 1 - row : row;
+        timestamps[slot] = reading.timestampMs;
+        glucose[slot] = reading.mmol;
+        row++;
+    }
+    ok = ok && row == rows;    // the source changed under us otherwise
+    if (ok && !ascending && !descending) {
+        // Shuffled source: the only case that needs a copy in memory
+        std::vector<std::pair<std::int64_t, float>> sorted(rows);
+        for (std::uint64_t i = 0; i < rows; i++)
+            sorted[i] = {timestamps[i], glucose[i]};
+        std::stable_sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        for (std::uint64_t i = 0; i < rows; i++) {
+            timestamps[i] = sorted[i].first;
+            glucose[i] = sorted[i].second;
+        }
+    }
+    // Carbs / bolus / basal stay zero from ftruncate
+
+    std::memcpy(image, &header, sizeof(Header));
+    ok = msync(memory, header.fileSize, MS_SYNC) == 0 && ok;
+    munmap(memory, header.fileSize);
+    ok = ::close(fd) == 0 && ok;
+    if (!ok || std::rename(tempPath.c_str(), cachePath.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+#else
+    (void)sourcePath;
+    (void)cachePath;
+    return false;
+#endif
+}
+
+std::size_t TraceCache::rows() const {
+    return m_header ? static_cast<std::size_t>(m_header->rows) : 0;
+}
+
+bool TraceCache::rebuilt() const {
+    return m_rebuilt;
+}
+
+TraceSpan<std::int64_t> TraceCache::timestamps() const {
+    return column<std::int64_t>(Timestamps);
+}
+
+TraceSpan<float> TraceCache::glucose() const {
+    return column<float>(Glucose);
+}
+
+TraceSpan<float> TraceCache::carbs() const {
+    return column<float>(Carbs);
+}
+
+TraceSpan<float> TraceCache::bolus() const {
+    return column<float>(Bolus);
+}
+
+TraceSpan<float> TraceCache::basal() const {
+    return column<float>(Basal);
+}
+
+void TraceCache::layout(Header& header, std::uint64_t rows) {
+    static const std::uint64_t kWidths[ColumnCount] = {sizeof(std::int64_t), sizeof(float), sizeof(float),
+                                                       sizeof(float), sizeof(float)};
+    header.rows = rows;
+    std::uint64_t offset = alignUp(sizeof(Header));
+    for (int c = 0; c < ColumnCount; c++) {
+        header.columnOffset[c] = offset;
+        offset = alignUp(offset + rows * kWidths[c]);
+    }
+    header.fileSize = offset;
+}
+
+bool TraceCache::isFresh(const std::string& sourcePath) const {
+#ifdef TRACECACHE_POSIX
+    std::uint64_t size = 0;
+    std::int64_t mtimeNs = 0;
+    return m_header && statSource(sourcePath, size, mtimeNs)
+           && size == m_header->sourceSize && mtimeNs == m_header->sourceMtimeNs;
+#else
+    (void)sourcePath;
+    return false;
+#endif
+}
+
+template <typename T>
+TraceSpan<T> TraceCache::column(Column column) const {
+    if (!m_header)
+        return TraceSpan<T>();
+    return TraceSpan<T>(reinterpret_cast<const T*>(m_image + m_header->columnOffset[column]), rows());
+}
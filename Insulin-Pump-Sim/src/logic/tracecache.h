@@ -0,0 +1,102 @@
+#ifndef TRACECACHE_H
+#define TRACECACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only view of one column, straight out of the mapping
+template <typename T>
+class TraceSpan {
+public:
+    TraceSpan() : m_data(nullptr), m_size(0) {}
+    TraceSpan(const T* data, std::size_t size) : m_data(data), m_size(size) {}
+
+    const T* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    const T* begin() const { return m_data; }
+    const T* end() const { return m_data + m_size; }
+    const T& operator[](std::size_t i) const { return m_data[i]; }
+
+private:
+    const T* m_data;
+    std::size_t m_size;
+};
+
+//--------------------------------------------------------
+// TRACE CACHE (columnar binary copy of an imported dataset)
+// A 128-byte header followed by one 64-byte aligned array
+// per signal: timestamps (int64 ms), then glucose (mmol/L),
+// carbs (g), bolus (u) and basal (u) as floats, one row per
+// CGM reading, oldest first whatever order the source is in.
+// CGM-only sources leave the last three at zero.
+// load() maps the cache next to the source file and hands out
+// spans into the mapping; a missing or stale cache (source
+// size / mtime changed) is rebuilt first. Building parses the
+// source twice, counting rows and then writing them straight
+// into the mapped output (reversed for a newest-first source),
+// so memory stays flat; only a source in no order at all is
+// sorted through a copy. The file is written beside the cache
+// and renamed into place.
+//--------------------------------------------------------
+class TraceCache {
+public:
+    static constexpr std::uint32_t kVersion = 2;      // 2: rows sorted by time
+    static constexpr std::size_t kAlignment = 64;
+
+    enum Column {
+        Timestamps,
+        Glucose,
+        Carbs,
+        Bolus,
+        Basal,
+        ColumnCount
+    };
+
+    TraceCache();
+    ~TraceCache();
+    TraceCache(const TraceCache&) = delete;
+    TraceCache& operator=(const TraceCache&) = delete;
+
+    // Map the cache for sourcePath, building it when needed
+    bool load(const std::string& sourcePath);
+    // Map an existing cache file as is
+    bool open(const std::string& cachePath);
+    void close();
+    static bool build(const std::string& sourcePath, const std::string& cachePath);
+    static std::string cachePathFor(const std::string& sourcePath);
+
+    std::size_t rows() const;
+    bool rebuilt() const;        // last load() had to parse the source
+    TraceSpan<std::int64_t> timestamps() const;
+    TraceSpan<float> glucose() const;
+    TraceSpan<float> carbs() const;
+    TraceSpan<float> bolus() const;
+    TraceSpan<float> basal() const;
+
+private:
+    struct Header {
+        char magic[8];              // "PUMPTRCE"
+        std::uint32_t version;
+        std::uint32_t headerSize;
+        std::uint64_t rows;
+        std::uint64_t sourceSize;
+        std::int64_t sourceMtimeNs;
+        std::uint64_t columnOffset[ColumnCount];
+        std::uint64_t fileSize;
+        std::uint32_t reserved[10];
+    };
+
+    static void layout(Header& header, std::uint64_t rows);
+    bool isFresh(const std::string& sourcePath) const;
+    template <typename T>
+    TraceSpan<T> column(Column column) const;
+
+    const unsigned char* m_image;
+    std::size_t m_imageSize;
+    const Header* m_header;
+    bool m_rebuilt;
+};
+
+#endif // TRACECACHE_H
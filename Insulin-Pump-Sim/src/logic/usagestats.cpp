@@ -0,0 +1,143 @@
+#include "usagestats.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double kMgPerMmol = 18.0182;
+constexpr double kMsPerDay = 24.0 * 60.0 * 60.0 * 1000.0;
+}
+
+UsageStats::UsageStats()
+    : m_samples(0), m_bandMs{0, 0, 0}, m_lastBand(InRange), m_lastReadingMs(-1),
+    m_mean(0.0), m_m2(0.0),
+    m_basal(0), m_bolus(0), m_bolusCount(0), m_extendedCount(0),
+    m_firstMs(-1), m_lastMs(-1)
+{}
+
+void UsageStats::addGlucose(double mmol, std::int64_t timestampMs) {
+    touch(timestampMs);
+    Band band = mmol < kRangeLow ? Below : mmol > kRangeHigh ? Above : InRange;
+    // An out-of-order reading still counts toward the mean, but not toward time
+    if (m_lastReadingMs < 0 || timestampMs >= m_lastReadingMs) {
+        if (m_lastReadingMs >= 0)
+            m_bandMs[m_lastBand] += std::min(timestampMs - m_lastReadingMs, kMaxReadingMs);
+        m_lastBand = band;
+        m_lastReadingMs = timestampMs;
+    }
+
+    m_samples++;
+    double delta = mmol - m_mean;
+    m_mean += delta / m_samples;
+    m_m2 += delta * (mmol - m_mean);
+}
+
+void UsageStats::addBasal(MicroUnits delivered, std::int64_t timestampMs) {
+    touch(timestampMs);
+    m_basal += delivered;
+}
+
+void UsageStats::addBolus(MicroUnits delivered, bool extended, std::int64_t timestampMs) {
+    touch(timestampMs);
+    m_bolus += delivered;
+    m_bolusCount++;
+    if (extended)
+        m_extendedCount++;
+}
+
+void UsageStats::addBolusUnits(MicroUnits delivered, std::int64_t timestampMs) {
+    touch(timestampMs);
+    m_bolus += delivered;
+}
+
+void UsageStats::addTrace(const std::int64_t* timestampsMs, const float* glucose,
+                          const float* bolus, const float* basal, std::size_t rows) {
+    // Datasets store units; converted once here
+    for (std::size_t i = 0; i < rows; i++) {
+        addGlucose(glucose[i], timestampsMs[i]);
+        if (bolus && bolus[i] > 0.0f)
+            addBolus(InsulinUnits::fromUnits(bolus[i]), false, timestampsMs[i]);
+        if (basal && basal[i] > 0.0f)
+            addBasal(InsulinUnits::fromUnits(basal[i]), timestampsMs[i]);
+    }
+}
+
+int UsageStats::glucoseSamples() const {
+    return m_samples;
+}
+
+double UsageStats::timeInRangePct() const {
+    return bandPct(InRange);
+}
+
+double UsageStats::timeBelowRangePct() const {
+    return bandPct(Below);
+}
+
+double UsageStats::timeAboveRangePct() const {
+    return bandPct(Above);
+}
+
+double UsageStats::bandPct(Band band) const {
+    std::int64_t total = m_bandMs[Below] + m_bandMs[InRange] + m_bandMs[Above];
+    if (total > 0)
+        return 100.0 * m_bandMs[band] / total;
+    // A single reading (or readings at one instant): all in its band
+    return m_samples && m_lastBand == band ? 100.0 : 0.0;
+}
+
+double UsageStats::meanGlucose() const {
+    return m_mean;
+}
+
+double UsageStats::glucoseManagementIndicator() const {
+    if (m_samples == 0)
+        return 0.0;
+    // Bergenstal et al. 2018: GMI(%) = 3.31 + 0.02392 * mean glucose (mg/dL)
+    return 3.31 + 0.02392 * (m_mean * kMgPerMmol);
+}
+
+double UsageStats::coefficientOfVariationPct() const {
+    if (m_samples < 2 || m_mean <= 0.0)
+        return 0.0;
+    double sd = std::sqrt(m_m2 / (m_samples - 1));
+    return 100.0 * sd / m_mean;
+}
+
+double UsageStats::totalBasal() const {
+    return InsulinUnits::toUnits(m_basal);
+}
+
+double UsageStats::totalBolus() const {
+    return InsulinUnits::toUnits(m_bolus);
+}
+
+double UsageStats::totalDailyDose() const {
+    return InsulinUnits::toUnits(m_basal + m_bolus) / days();
+}
+
+double UsageStats::dailyBasal() const {
+    return InsulinUnits::toUnits(m_basal) / days();
+}
+
+double UsageStats::dailyBolus() const {
+    return InsulinUnits::toUnits(m_bolus) / days();
+}
+
+int UsageStats::bolusCount() const {
+    return m_bolusCount;
+}
+
+int UsageStats::extendedBolusCount() const {
+    return m_extendedCount;
+}
+
+void UsageStats::touch(std::int64_t timestampMs) {
+    m_firstMs = m_firstMs < 0 ? timestampMs : std::min(m_firstMs, timestampMs);
+    m_lastMs = std::max(m_lastMs, timestampMs);
+}
+
+double UsageStats::days() const {
+    if (m_firstMs < 0)
+        return 1.0;
+    return std::max(1.0, (m_lastMs - m_firstMs) / kMsPerDay);
+}
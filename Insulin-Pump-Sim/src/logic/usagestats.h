@@ -0,0 +1,80 @@
+#ifndef USAGESTATS_H
+#define USAGESTATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include "src/models/insulinunits.h"
+#include "simclock.h"
+
+//--------------------------------------------------------
+// USAGE STATS
+// Running accumulators behind DataManager::analyzeUsage.
+// Every add* call is O(1) and every getter is O(1), so the
+// summary never needs to rescan the event history. Insulin
+// totals are kept in micro-units, so they do not drift.
+// Timestamps are simulated pump time (SimClock). Time in
+// range weights each reading by the time until the next one,
+// capped at one delivery tick so sensor gaps are not filled.
+//--------------------------------------------------------
+class UsageStats {
+public:
+    // Consensus CGM target range (mmol/L)
+    static constexpr double kRangeLow  = 3.9;
+    static constexpr double kRangeHigh = 10.0;
+    // Longest stretch a single reading stands for
+    static constexpr std::int64_t kMaxReadingMs = SimClock::kTickSimMs;
+
+    UsageStats();
+
+    void addGlucose(double mmol, std::int64_t timestampMs);
+    void addBasal(MicroUnits delivered, std::int64_t timestampMs);
+    void addBolus(MicroUnits delivered, bool extended, std::int64_t timestampMs);
+    // Insulin from a bolus already counted by addBolus (extended steps)
+    void addBolusUnits(MicroUnits delivered, std::int64_t timestampMs);
+    // Whole imported trace, column by column (bolus / basal may be null)
+    void addTrace(const std::int64_t* timestampsMs, const float* glucose,
+                  const float* bolus, const float* basal, std::size_t rows);
+
+    int glucoseSamples() const;
+    double timeInRangePct() const;
+    double timeBelowRangePct() const;
+    double timeAboveRangePct() const;
+    double meanGlucose() const;                 // mmol/L
+    double glucoseManagementIndicator() const;  // GMI / estimated A1c (%)
+    double coefficientOfVariationPct() const;
+
+    double totalBasal() const;
+    double totalBolus() const;
+    // Total insulin averaged over the days covered by the log (minimum one day)
+    double totalDailyDose() const;
+    double dailyBasal() const;
+    double dailyBolus() const;
+    int bolusCount() const;
+    int extendedBolusCount() const;
+
+private:
+    enum Band { Below, InRange, Above, BandCount };
+
+    void touch(std::int64_t timestampMs);
+    double days() const;
+    double bandPct(Band band) const;
+
+    int m_samples;
+    // Time each band held, credited when the next reading arrives
+    std::int64_t m_bandMs[BandCount];
+    Band m_lastBand;
+    std::int64_t m_lastReadingMs;
+    // Welford running mean / variance
+    double m_mean;
+    double m_m2;
+
+    MicroUnits m_basal;
+    MicroUnits m_bolus;
+    int m_bolusCount;
+    int m_extendedCount;
+
+    std::int64_t m_firstMs;
+    std::int64_t m_lastMs;
+};
+
+#endif // USAGESTATS_H
@@ -1,17 +1,34 @@
 #include "insulincartridge.h"
 
-InsulinCartridge::InsulinCartridge() : insulinLevel(300), occluded(false) {}
+InsulinCartridge::InsulinCartridge()
+    : insulin(kCapacityUnits * InsulinUnits::kPerUnit), occluded(false) {}
 
 void InsulinCartridge::updateInsulinLevel(int newLevel) {
-    insulinLevel = newLevel;
+    insulin = static_cast<MicroUnits>(newLevel) * InsulinUnits::kPerUnit;
+}
+
+void InsulinCartridge::setInsulin(MicroUnits amount) {
+    insulin = amount > 0 ? amount : 0;
+}
+
+MicroUnits InsulinCartridge::withdraw(MicroUnits amount) {
+    if (amount <= 0)
+        return 0;
+    MicroUnits taken = amount < insulin ? amount : insulin;
+    insulin -= taken;
+    return taken;
 }
 
 void InsulinCartridge::refill() {
-    insulinLevel = 300; //Default Insulin
+    insulin = kCapacityUnits * InsulinUnits::kPerUnit; //Default Insulin
 }
 
 int InsulinCartridge::getInsulinLevel() const {
-    return insulinLevel;
+    return static_cast<int>(insulin / InsulinUnits::kPerUnit);
+}
+
+MicroUnits InsulinCartridge::getInsulin() const {
+    return insulin;
 }
 
 bool InsulinCartridge::isOccluded() const {
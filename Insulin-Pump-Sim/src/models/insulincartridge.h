@@ -1,17 +1,26 @@
 #ifndef INSULINCARTRIDGE_H
 #define INSULINCARTRIDGE_H
 
+#include "insulinunits.h"
+
 //--------------------------------------------------------
 // INSULINCARTRIDGE
+// Holds micro-units; whole units are only for the display.
 //--------------------------------------------------------
 class InsulinCartridge {
 public:
-    int insulinLevel;
+    static constexpr int kCapacityUnits = 300;
+
+    MicroUnits insulin;
     bool occluded; //occlusion flag
     InsulinCartridge();
     void updateInsulinLevel(int newLevel);
+    void setInsulin(MicroUnits amount);
+    // Take up to amount out; returns what was actually taken
+    MicroUnits withdraw(MicroUnits amount);
     void refill();
-    int getInsulinLevel() const;
+    int getInsulinLevel() const;     // whole units, rounded down
+    MicroUnits getInsulin() const;
     bool isOccluded() const;
     void setOcclusion(bool status);
 };
@@ -1,4 +1,5 @@
 #include "insulinpump.h"
+#include "src/logic/logger.h"
 
 InsulinPump::InsulinPump() : state(Off), currentProfile(nullptr) {}
 
@@ -11,9 +12,9 @@ void InsulinPump::powerOff() {
 }
 
 void InsulinPump::navigateTo(const std::string& screen) {
-    std::cout << "Navigating to " << screen << "\n";
+    Logger::instance().logf(LogChannel::Console, "Navigating to %s", screen.c_str());
 }
 
 void InsulinPump::updateDisplay() {
-    std::cout << "Display updated.\n";
+    Logger::instance().logf(LogChannel::Console, "Display updated.");
 }
@@ -1,7 +1,6 @@
 #ifndef INSULINPUMP_H
 #define INSULINPUMP_H
 
-#include <iostream>
 #include <string>
 
 //--------------------------------------------------------
@@ -0,0 +1,30 @@
+#ifndef INSULINUNITS_H
+#define INSULINUNITS_H
+
+#include <cmath>
+#include <cstdint>
+
+//--------------------------------------------------------
+// INSULIN UNITS (fixed-point insulin ledger)
+// Cartridge, IOB, basal and bolus amounts are all integer
+// micro-units (1 u = 1,000,000 uU). Moving insulin between
+// them is exact, so what leaves the cartridge is what lands
+// in IOB, and results are bit-identical on every platform.
+// Floating point is only used at the edges: profile rates,
+// dialog input and the display.
+//--------------------------------------------------------
+using MicroUnits = std::int64_t;
+
+class InsulinUnits {
+public:
+    static constexpr MicroUnits kPerUnit = 1000000;
+
+    static MicroUnits fromUnits(double units) {
+        return static_cast<MicroUnits>(std::llround(units * kPerUnit));
+    }
+    static double toUnits(MicroUnits amount) {
+        return static_cast<double>(amount) / kPerUnit;
+    }
+};
+
+#endif // INSULINUNITS_H
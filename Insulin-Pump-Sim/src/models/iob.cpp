@@ -1,22 +1,30 @@
 #include "iob.h"
 
-IOB::IOB() : activeInsulinUnits(0.0f) {}
+IOB::IOB() : activeInsulin(0) {}
 
 void IOB::updateIOB(float units) {
-    activeInsulinUnits = units;
+    activeInsulin = InsulinUnits::fromUnits(units);
+}
+
+void IOB::add(MicroUnits amount) {
+    activeInsulin += amount;
 }
 
 float IOB::getIOB() const {
-    return activeInsulinUnits;
+    return static_cast<float>(InsulinUnits::toUnits(activeInsulin));
+}
+
+MicroUnits IOB::getActive() const {
+    return activeInsulin;
 }
 
 
 void IOB::decay(float decayRate) {
-    activeInsulinUnits -= decayRate;
-    if (activeInsulinUnits < 0.0f)
-        activeInsulinUnits = 0.0f;
+    activeInsulin -= InsulinUnits::fromUnits(decayRate);
+    if (activeInsulin < 0)
+        activeInsulin = 0;
 }
 
 bool IOB::isActive() const {
-    return activeInsulinUnits > 0.0f;
+    return activeInsulin > 0;
 }
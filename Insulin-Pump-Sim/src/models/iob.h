@@ -1,15 +1,20 @@
 #ifndef IOB_H
 #define IOB_H
 
+#include "insulinunits.h"
+
 //--------------------------------------------------------
 // IOB
 //--------------------------------------------------------
 class IOB {
 public:
-    float activeInsulinUnits;
+    MicroUnits activeInsulin;
     IOB();
     void updateIOB(float units);
+    // Insulin just delivered (taken from the cartridge)
+    void add(MicroUnits amount);
     float getIOB() const;
+    MicroUnits getActive() const;
 
     void decay(float decayRate = 0.5f);  // Default decay per tick
     bool isActive() const;               // Optional helper
@@ -1,4 +1,5 @@
 #include "profile.h"
+#include "src/logic/logger.h"
 
 Profile::Profile(const std::string& n, float basal, float carb, float correction, float target)
     : name(n), basalRate(basal), carbRatio(carb), correctionFactor(correction), targetGlucose(target) {}
@@ -28,5 +29,5 @@ void Profile::updateSettings(float basal, float carb, float correction, float ta
     carbRatio = carb;
     correctionFactor = correction;
     targetGlucose = target;
-    std::cout << "Updated profile: " << name << "\n";
+    Logger::instance().logf(LogChannel::Console, "Updated profile: %s", name.c_str());
 }
@@ -1,8 +1,8 @@
 #ifndef PROFILE_H
 #define PROFILE_H
 
+#include <cstddef>
 #include <string>
-#include <iostream>
 
 //--------------------------------------------------------
 // PROFILE
@@ -15,6 +15,9 @@ private:
     float correctionFactor;
     float targetGlucose;
 public:
+    // Names are stored in fixed-size records (UTF-8 bytes)
+    static constexpr std::size_t kMaxNameLength = 64;
+
     Profile(const std::string& n, float basal, float carb, float correction, float target);
     std::string getName() const;
     float getBasalRate() const;
@@ -1,29 +1,173 @@
 #include "profilemanager.h"
+#include "src/logic/logger.h"
 
-void ProfileManager::createProfile(const Profile& profile) {
-    profiles.push_back(profile);
+ProfileHandle ProfileManager::createProfile(const Profile& profile) {
+    std::string name = profile.getName();
+    if (name.size() > Profile::kMaxNameLength)
+        return ProfileHandle();
+    auto inserted = m_nameIndex.emplace(std::move(name), 0u);
+    if (!inserted.second)
+        return ProfileHandle();
+
+    std::uint32_t index;
+    bool appended = m_freeSlots.empty();
+    if (appended) {
+        index = static_cast<std::uint32_t>(m_slots.size());
+        if (m_listener)
+            m_listener->profileAboutToBeAdded(static_cast<int>(index));
+        m_slots.emplace_back();
+    } else {
+        index = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+
+    Slot& slot = m_slots[index];
+    slot.profile.emplace(profile);
+    slot.name = &inserted.first->first;
+    inserted.first->second = index;
+    m_size++;
+    markDirty(index);
+
+    if (m_listener) {
+        if (appended)
+            m_listener->profileAdded(static_cast<int>(index));
+        else
+            m_listener->profileChanged(static_cast<int>(index));
+    }
+    changed();
+    return ProfileHandle{index, slot.generation};
 }
 
+bool ProfileManager::updateProfile(ProfileHandle handle, float basal, float carb, float correction, float target) {
+    Profile* profile = selectProfile(handle);
+    if (!profile)
+        return false;
+    profile->updateSettings(basal, carb, correction, target);
+    markDirty(handle.index);
+    if (m_listener)
+        m_listener->profileChanged(static_cast<int>(handle.index));
+    changed();
+    return true;
+}
 
-const std::vector<Profile>& ProfileManager::getProfiles() const {
-    return profiles;
+Profile* ProfileManager::get(ProfileHandle handle) {
+    return const_cast<Profile*>(static_cast<const ProfileManager*>(this)->get(handle));
 }
 
+const Profile* ProfileManager::get(ProfileHandle handle) const {
+    if (!contains(handle) || m_slots[handle.index].unverified)
+        return nullptr;
+    return &*m_slots[handle.index].profile;
+}
 
-Profile* ProfileManager::selectProfile(const std::string& name) {
-    for (auto& p : profiles) {
-        if (p.getName() == name)
-            return &p;
+Profile* ProfileManager::findById(std::uint64_t id) {
+    return get(ProfileHandle::fromId(id));
+}
+
+ProfileHandle ProfileManager::findProfile(const std::string& name) const {
+    auto it = m_nameIndex.find(name);
+    if (it == m_nameIndex.end())
+        return ProfileHandle();
+    return ProfileHandle{it->second, m_slots[it->second].generation};
+}
+
+Profile* ProfileManager::selectProfile(ProfileHandle handle) {
+    if (!contains(handle))
+        return nullptr;
+    if (!verify(handle.index)) {
+        changed();  // the dropped record gets saved as deleted
+        return nullptr;
     }
-    return nullptr;
+    return &*m_slots[handle.index].profile;
+}
+
+Profile* ProfileManager::selectProfile(const std::string& name) {
+    return selectProfile(findProfile(name));
 }
 
 //Remove the profile if chosen to be deleted
-void ProfileManager::deleteProfile(const std::string& name) {
-    auto it = std::remove_if(profiles.begin(), profiles.end(), [&](const Profile& p) {
-        return p.getName() == name;
-    });
-    if(it != profiles.end()){
-        profiles.erase(it, profiles.end());
-    }
+bool ProfileManager::deleteProfile(ProfileHandle handle) {
+    if (!contains(handle))
+        return false;
+    freeSlot(handle.index);
+    if (m_listener)
+        m_listener->profileChanged(static_cast<int>(handle.index));
+    changed();
+    return true;
+}
+
+bool ProfileManager::deleteProfile(const std::string& name) {
+    return deleteProfile(findProfile(name));
+}
+
+std::size_t ProfileManager::size() const {
+    return m_size;
+}
+
+std::size_t ProfileManager::slotCount() const {
+    return m_slots.size();
+}
+
+const Profile* ProfileManager::profileAt(std::size_t slot) const {
+    if (slot >= m_slots.size() || !m_slots[slot].profile)
+        return nullptr;
+    return &*m_slots[slot].profile;
+}
+
+void ProfileManager::setListener(ProfileListener* listener) {
+    m_listener = listener;
+}
+
+void ProfileManager::setChangedCallback(std::function<void()> callback) {
+    m_changed = std::move(callback);
+}
+
+bool ProfileManager::contains(ProfileHandle handle) const {
+    return handle.index < m_slots.size()
+           && m_slots[handle.index].generation == handle.generation
+           && m_slots[handle.index].profile;
+}
+
+// Loaded records are checksummed on first selection; a bad one is dropped.
+// ProfileStore also calls this before the image goes away, mid-save, so
+// only the listener hears about it here.
+bool ProfileManager::verify(std::uint32_t index) {
+    Slot& slot = m_slots[index];
+    if (!slot.profile)
+        return false;
+    if (!slot.unverified)
+        return true;
+    slot.unverified = false;
+    if (!m_verifier || m_verifier(index))
+        return true;
+    Logger::instance().logf(LogChannel::Console, "Profile record %u failed its checksum; dropped", index);
+    freeSlot(index);
+    if (m_listener)
+        m_listener->profileChanged(static_cast<int>(index));
+    return false;
+}
+
+void ProfileManager::freeSlot(std::uint32_t index) {
+    Slot& slot = m_slots[index];
+    m_nameIndex.erase(m_nameIndex.find(*slot.name));
+    slot.name = nullptr;
+    slot.profile.reset();
+    slot.unverified = false;
+    slot.generation++;
+    m_freeSlots.push_back(index);
+    m_size--;
+    markDirty(index);
+}
+
+void ProfileManager::markDirty(std::uint32_t index) {
+    Slot& slot = m_slots[index];
+    if (slot.dirty)
+        return;
+    slot.dirty = true;
+    m_dirtySlots.push_back(index);
+}
+
+void ProfileManager::changed() {
+    if (m_changed)
+        m_changed();
 }
@@ -2,22 +2,122 @@
 #define PROFILEMANAGER_H
 
 #include "profile.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
 #include <vector>
-#include <algorithm>
+
+//--------------------------------------------------------
+// PROFILE HANDLE
+// Slot index + generation. A handle to a deleted profile
+// stops resolving instead of dangling, even after its slot
+// is reused by a new profile.
+//--------------------------------------------------------
+struct ProfileHandle {
+    static constexpr std::uint32_t kInvalidIndex = 0xFFFFFFFFu;
+
+    std::uint32_t index = kInvalidIndex;
+    std::uint32_t generation = 0;
+
+    bool isValid() const { return index != kInvalidIndex; }
+    // Packed form for storage / lookup by ID
+    std::uint64_t id() const { return (static_cast<std::uint64_t>(generation) << 32) | index; }
+    static ProfileHandle fromId(std::uint64_t id) {
+        return ProfileHandle{static_cast<std::uint32_t>(id), static_cast<std::uint32_t>(id >> 32)};
+    }
+
+    bool operator==(const ProfileHandle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const ProfileHandle& other) const { return !(*this == other); }
+};
+
+//--------------------------------------------------------
+// PROFILE LISTENER (slot-level change notifications)
+// Rows are slot indices and never move; a deleted or reused
+// slot is reported as changed.
+//--------------------------------------------------------
+class ProfileListener {
+public:
+    virtual ~ProfileListener() = default;
+    virtual void profileAboutToBeAdded(int row) = 0;
+    virtual void profileAdded(int row) = 0;
+    virtual void profileChanged(int row) = 0;
+    // Whole collection replaced (ProfileStore::load)
+    virtual void profilesAboutToBeReset() = 0;
+    virtual void profilesReset() = 0;
+};
 
 //--------------------------------------------------------
 // PROFILE MANAGER
+// Profiles live in a deque of slots, so pointers stay valid
+// while the collection grows. Deleted slots go on a free
+// list (O(1) delete) and bump their generation. Names are
+// unique and hash-indexed for O(1) lookup. Changed slots
+// are tracked so ProfileStore only writes those records.
+// Loaded records are checksummed when first selected, never
+// from a const lookup; a bad one is dropped and reported.
 //--------------------------------------------------------
 class ProfileManager {
-private:
-    std::vector<Profile> profiles;
 public:
-    //Create profiel
-    void createProfile(const Profile& profile);
-    const std::vector<Profile>& getProfiles() const;
+    //Create profile -> invalid handle if the name is taken or too long
+    ProfileHandle createProfile(const Profile& profile);
+    // Edit settings through the manager so the change gets saved
+    bool updateProfile(ProfileHandle handle, float basal, float carb, float correction, float target);
+
+    // O(1) lookups; nullptr / invalid handle when not found or not yet selected after a load
+    Profile* get(ProfileHandle handle);
+    const Profile* get(ProfileHandle handle) const;
+    Profile* findById(std::uint64_t id);
+    ProfileHandle findProfile(const std::string& name) const;
+    // Checks a loaded profile's checksum on first use; a bad record is dropped (listener notified)
+    Profile* selectProfile(ProfileHandle handle);
     Profile* selectProfile(const std::string& name);
+
     //Remove Profile
-    void deleteProfile(const std::string& name);
+    bool deleteProfile(ProfileHandle handle);
+    bool deleteProfile(const std::string& name);
+
+    std::size_t size() const;
+    // Slots (live and free) for row-based views; includes profiles not yet checked
+    std::size_t slotCount() const;
+    const Profile* profileAt(std::size_t slot) const;
+
+    // One listener (the profile list model) gets slot notifications
+    void setListener(ProfileListener* listener);
+    // Called after every create / update / delete (used to autosave)
+    void setChangedCallback(std::function<void()> callback);
+
+private:
+    friend class ProfileStore;
+
+    struct Slot {
+        std::optional<Profile> profile;
+        std::uint32_t generation = 0;
+        const std::string* name = nullptr;  // interned key in m_nameIndex
+        bool dirty = false;       // not yet written by ProfileStore
+        bool unverified = false;  // loaded, checksum not checked yet
+    };
+
+    bool contains(ProfileHandle handle) const;
+    bool verify(std::uint32_t index);
+    void freeSlot(std::uint32_t index);
+    void markDirty(std::uint32_t index);
+    void changed();
+
+    std::deque<Slot> m_slots;
+    std::vector<std::uint32_t> m_freeSlots;
+    std::unordered_map<std::string, std::uint32_t> m_nameIndex;
+    std::vector<std::uint32_t> m_dirtySlots;
+    std::size_t m_size = 0;
+    ProfileListener* m_listener = nullptr;
+    std::function<void()> m_changed;
+    // Set by ProfileStore while records are still memory-mapped
+    std::function<bool(std::uint32_t)> m_verifier;
 };
 
 #endif // PROFILEMANAGER_H
@@ -0,0 +1,381 @@
+#include "profilestore.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PROFILESTORE_POSIX 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr char kMagic[8] = {'P', 'U', 'M', 'P', 'P', 'R', 'O', 'F'};
+// Compact once the log holds this many records beyond two per slot
+constexpr std::uint64_t kCompactSlack = 1024;
+
+std::uint32_t crc32(const void* data, std::size_t length) {
+    static const auto table = [] {
+        struct { std::uint32_t v[256]; } t;
+        for (std::uint32_t i = 0; i < 256; i++) {
+            std::uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t.v[i] = c;
+        }
+        return t;
+    }();
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    std::uint32_t crc = 0xFFFFFFFFu;
+    for (std::size_t i = 0; i < length; i++)
+        crc = table.v[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+}
+
+ProfileStore::ProfileStore(ProfileManager* manager, const std::string& path)
+    : m_manager(manager),
+    m_path(path),
+    m_image(nullptr),
+    m_imageSize(0),
+    m_mapped(false),
+    m_committed(0),
+    m_fd(-1)
+{
+    static_assert(sizeof(Header) == 64, "header layout");
+    static_assert(sizeof(Record) == 96, "record layout");
+}
+
+ProfileStore::~ProfileStore() {
+    releaseMapping();
+    closeFile();
+}
+
+bool ProfileStore::load() {
+    // The profiles are about to be replaced; skip their pending checks
+    m_manager->m_verifier = nullptr;
+    releaseMapping();
+    closeFile();
+    m_committed = 0;
+    if (!mapFile())
+        return false;
+
+    // Pass 1: newest record for every slot (slot numbers only)
+    std::uint32_t slotCount = 0;
+    if (m_imageSize > 0) {
+        Header header;
+        std::memcpy(&header, m_image, sizeof(header));
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0
+            || header.checksum != crc32(&header, offsetof(Header, checksum)))
+            return fail("not a profile file: " + m_path);
+        if (header.version != kVersion || header.recordSize != sizeof(Record))
+            return fail("unsupported profile file version");
+        std::uint64_t available = (m_imageSize - sizeof(Header)) / sizeof(Record);
+        m_committed = std::min(header.committedRecords, available);
+        m_latest.assign(header.slotCount, kNoRecord);
+        const Record* records = reinterpret_cast<const Record*>(m_image + sizeof(Header));
+        for (std::uint64_t r = 0; r < m_committed; r++) {
+            std::uint32_t slot = records[r].slot;
+            if (slot >= m_latest.size())
+                continue;
+            m_latest[slot] = static_cast<std::uint32_t>(r);
+        }
+        slotCount = header.slotCount;
+    }
+
+    // Pass 2: rebuild the slots; checksums wait until first use
+    if (m_manager->m_listener)
+        m_manager->m_listener->profilesAboutToBeReset();
+    ProfileManager& pm = *m_manager;
+    pm.m_slots.clear();
+    pm.m_freeSlots.clear();
+    pm.m_nameIndex.clear();
+    pm.m_dirtySlots.clear();
+    pm.m_size = 0;
+    pm.m_nameIndex.reserve(slotCount);
+    pm.m_slots.resize(slotCount);
+
+    const Record* records = reinterpret_cast<const Record*>(m_image + sizeof(Header));
+    for (std::uint32_t slot = slotCount; slot-- > 0;) {
+        ProfileManager::Slot& target = pm.m_slots[slot];
+        std::uint32_t r = m_latest[slot];
+        if (r != kNoRecord) {
+            const Record& record = records[r];
+            target.generation = record.generation;
+            if (record.live && record.nameLength <= Profile::kMaxNameLength) {
+                auto inserted = pm.m_nameIndex.emplace(std::string(record.name, record.nameLength), slot);
+                if (inserted.second) {
+                    target.profile.emplace(inserted.first->first, record.basalRate, record.carbRatio,
+                                           record.correctionFactor, record.targetGlucose);
+                    target.name = &inserted.first->first;
+                    target.unverified = true;
+                    pm.m_size++;
+                    continue;
+                }
+            }
+        }
+        pm.m_freeSlots.push_back(slot);
+    }
+    pm.m_verifier = [this](std::uint32_t slot) { return verifyRecord(slot); };
+    if (pm.m_listener)
+        pm.m_listener->profilesReset();
+    return true;
+}
+
+bool ProfileStore::save() {
+    ProfileManager& pm = *m_manager;
+    if (pm.m_dirtySlots.empty())
+        return true;
+    if (!openForWrite())
+        return false;
+
+    std::vector<Record> batch(pm.m_dirtySlots.size());
+    for (std::size_t i = 0; i < batch.size(); i++) {
+        std::uint32_t slot = pm.m_dirtySlots[i];
+        fillRecord(batch[i], slot, pm.m_slots[slot]);
+    }
+    // Records first, header last: the header write commits them
+    std::uint64_t offset = sizeof(Header) + m_committed * sizeof(Record);
+    if (!writeAt(offset, batch.data(), batch.size() * sizeof(Record)) || !syncFile())
+        return fail("could not write profile records");
+    Header header;
+    sealHeader(header, m_committed + batch.size(), static_cast<std::uint32_t>(pm.m_slots.size()));
+    if (!writeAt(0, &header, sizeof(header)) || !syncFile())
+        return fail("could not commit profile records");
+    m_committed += batch.size();
+
+    for (std::uint32_t slot : pm.m_dirtySlots)
+        pm.m_slots[slot].dirty = false;
+    pm.m_dirtySlots.clear();
+
+    if (m_committed > 2 * pm.m_slots.size() + kCompactSlack)
+        return compact();
+    return true;
+}
+
+bool ProfileStore::compact() {
+    ProfileManager& pm = *m_manager;
+    // Check every pending record while the old image is still mapped
+    for (std::uint32_t slot = 0; slot < pm.m_slots.size(); slot++)
+        pm.verify(slot);
+
+    std::uint32_t slotCount = static_cast<std::uint32_t>(pm.m_slots.size());
+    std::vector<Record> records(slotCount);
+    for (std::uint32_t slot = 0; slot < slotCount; slot++)
+        fillRecord(records[slot], slot, pm.m_slots[slot]);
+    Header header;
+    sealHeader(header, slotCount, slotCount);
+
+    std::string temp = m_path + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record));
+        out.flush();
+        if (!out)
+            return fail("could not write " + temp);
+    }
+#ifdef PROFILESTORE_POSIX
+    int tempFd = ::open(temp.c_str(), O_RDONLY);
+    if (tempFd >= 0) {
+        ::fsync(tempFd);
+        ::close(tempFd);
+    }
+#else
+    std::remove(m_path.c_str());
+#endif
+    closeFile();
+    if (std::rename(temp.c_str(), m_path.c_str()) != 0)
+        return fail("could not replace " + m_path);
+
+    // Everything is in memory and verified; the old image is no longer needed
+    releaseMapping();
+    m_committed = slotCount;
+    for (ProfileManager::Slot& slot : pm.m_slots)
+        slot.dirty = false;
+    pm.m_dirtySlots.clear();
+    return true;
+}
+
+std::uint64_t ProfileStore::committedRecords() const {
+    return m_committed;
+}
+
+const std::string& ProfileStore::lastError() const {
+    return m_error;
+}
+
+void ProfileStore::fillRecord(Record& record, std::uint32_t slot, const ProfileManager::Slot& source) {
+    std::memset(&record, 0, sizeof(record));
+    record.slot = slot;
+    record.generation = source.generation;
+    if (source.profile) {
+        const Profile& profile = *source.profile;
+        const std::string& name = *source.name;
+        record.live = 1;
+        record.nameLength = static_cast<std::uint8_t>(name.size());
+        std::memcpy(record.name, name.data(), name.size());
+        record.basalRate = profile.getBasalRate();
+        record.carbRatio = profile.getCarbRatio();
+        record.correctionFactor = profile.getCorrectionFactor();
+        record.targetGlucose = profile.getTargetGlucose();
+    }
+    record.checksum = crc32(&record, offsetof(Record, checksum));
+}
+
+void ProfileStore::sealHeader(Header& header, std::uint64_t committed, std::uint32_t slotCount) {
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.recordSize = sizeof(Record);
+    header.committedRecords = committed;
+    header.slotCount = slotCount;
+    header.checksum = crc32(&header, offsetof(Header, checksum));
+}
+
+bool ProfileStore::verifyRecord(std::uint32_t slot) const {
+    if (slot >= m_latest.size() || m_latest[slot] == kNoRecord || !m_image)
+        return true;
+    const Record* record = reinterpret_cast<const Record*>(m_image + sizeof(Header)) + m_latest[slot];
+    return record->checksum == crc32(record, offsetof(Record, checksum));
+}
+
+bool ProfileStore::mapFile() {
+#ifdef PROFILESTORE_POSIX
+    int fd = ::open(m_path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return true;  // nothing saved yet
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return fail("could not stat " + m_path);
+    }
+    std::size_t size = static_cast<std::size_t>(info.st_size);
+    if (size >= sizeof(Header)) {
+        void* image = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (image == MAP_FAILED) {
+            ::close(fd);
+            return fail("could not map " + m_path);
+        }
+        m_image = static_cast<const unsigned char*>(image);
+        m_imageSize = size;
+        m_mapped = true;
+    }
+    ::close(fd);
+#else
+    std::ifstream in(m_path, std::ios::binary | std::ios::ate);
+    if (!in)
+        return true;  // nothing saved yet
+    std::streamoff size = in.tellg();
+    if (size >= static_cast<std::streamoff>(sizeof(Header))) {
+        m_buffer.resize(static_cast<std::size_t>(size));
+        in.seekg(0);
+        if (!in.read(reinterpret_cast<char*>(m_buffer.data()), size))
+            return fail("could not read " + m_path);
+        m_image = m_buffer.data();
+        m_imageSize = m_buffer.size();
+    }
+#endif
+    return true;
+}
+
+void ProfileStore::releaseMapping() {
+    if (m_manager->m_verifier) {
+        // Pending checks read the image; run them before it goes away
+        for (std::uint32_t slot = 0; slot < m_manager->m_slots.size(); slot++)
+            m_manager->verify(slot);
+        m_manager->m_verifier = nullptr;
+    }
+#ifdef PROFILESTORE_POSIX
+    if (m_mapped)
+        ::munmap(const_cast<unsigned char*>(m_image), m_imageSize);
+#endif
+    m_mapped = false;
+    m_image = nullptr;
+    m_imageSize = 0;
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+    m_latest.clear();
+}
+
+bool ProfileStore::openForWrite() {
+    bool fresh = false;
+#ifdef PROFILESTORE_POSIX
+    if (m_fd < 0) {
+        m_fd = ::open(m_path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (m_fd < 0)
+            return fail("could not open " + m_path);
+        struct stat info;
+        fresh = ::fstat(m_fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(Header));
+    }
+#else
+    if (m_fd < 0) {
+        std::ifstream probe(m_path, std::ios::binary | std::ios::ate);
+        fresh = !probe || probe.tellg() < static_cast<std::streamoff>(sizeof(Header));
+        if (fresh)
+            std::ofstream(m_path, std::ios::binary | std::ios::trunc);
+        m_fd = 0;
+    }
+#endif
+    if (fresh) {
+        // New (or replaced) file: start an empty log and rewrite every slot into it
+        m_committed = 0;
+        for (std::uint32_t slot = 0; slot < m_manager->m_slots.size(); slot++)
+            m_manager->markDirty(slot);
+        Header header;
+        sealHeader(header, 0, 0);
+        if (!writeAt(0, &header, sizeof(header)) || !syncFile())
+            return fail("could not initialise " + m_path);
+    }
+    return true;
+}
+
+bool ProfileStore::writeAt(std::uint64_t offset, const void* data, std::size_t length) {
+#ifdef PROFILESTORE_POSIX
+    const char* bytes = static_cast<const char*>(data);
+    while (length > 0) {
+        ssize_t written = ::pwrite(m_fd, bytes, length, static_cast<off_t>(offset));
+        if (written <= 0)
+            return false;
+        bytes += written;
+        offset += static_cast<std::uint64_t>(written);
+        length -= static_cast<std::size_t>(written);
+    }
+    return true;
+#else
+    std::fstream out(m_path, std::ios::binary | std::ios::in | std::ios::out);
+    out.seekp(static_cast<std::streamoff>(offset));
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(length));
+    out.flush();
+    return static_cast<bool>(out);
+#endif
+}
+
+bool ProfileStore::syncFile() {
+#ifdef PROFILESTORE_POSIX
+#if defined(__APPLE__)
+    return ::fsync(m_fd) == 0;
+#else
+    return ::fdatasync(m_fd) == 0;
+#endif
+#else
+    return true;  // the stream was flushed in writeAt
+#endif
+}
+
+void ProfileStore::closeFile() {
+#ifdef PROFILESTORE_POSIX
+    if (m_fd >= 0)
+        ::close(m_fd);
+#endif
+    m_fd = -1;
+}
+
+bool ProfileStore::fail(const std::string& message) {
+    m_error = message;
+    return false;
+}
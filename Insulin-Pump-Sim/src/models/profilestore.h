@@ -0,0 +1,95 @@
+#ifndef PROFILESTORE_H
+#define PROFILESTORE_H
+
+#include "profilemanager.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//--------------------------------------------------------
+// PROFILE STORE (binary persistence for ProfileManager)
+// The file is a 64-byte header followed by an append-only
+// log of fixed-size records, one per changed slot. The
+// header's committed record count is the commit point: a
+// save appends the dirty records, syncs, then rewrites the
+// header. Records past the committed count are ignored, so
+// a torn save leaves the previous state intact.
+//
+// load() memory-maps the file and only reads slot numbers
+// and names up front; each record's checksum is checked the
+// first time its profile is used. When the log grows past
+// twice the slot count it is compacted into a new file that
+// replaces the old one with rename().
+//--------------------------------------------------------
+class ProfileStore {
+public:
+    static constexpr std::uint32_t kVersion = 1;
+
+    ProfileStore(ProfileManager* manager, const std::string& path);
+    ~ProfileStore();
+
+    // Replace the manager's profiles with the file contents (a missing file is empty)
+    bool load();
+    // Append records for slots changed since the last save / load
+    bool save();
+    // Rewrite the file with one record per slot
+    bool compact();
+
+    std::uint64_t committedRecords() const;
+    const std::string& lastError() const;
+
+private:
+    struct Header {
+        char magic[8];              // "PUMPPROF"
+        std::uint32_t version;
+        std::uint32_t recordSize;
+        std::uint64_t committedRecords;
+        std::uint32_t slotCount;
+        std::uint32_t reserved[8];
+        std::uint32_t checksum;     // CRC-32 of the bytes above
+    };
+
+    struct Record {
+        std::uint32_t slot;
+        std::uint32_t generation;
+        std::uint8_t live;
+        std::uint8_t nameLength;
+        std::uint16_t reserved;
+        float basalRate;
+        float carbRatio;
+        float correctionFactor;
+        float targetGlucose;
+        char name[Profile::kMaxNameLength];
+        std::uint32_t checksum;     // CRC-32 of the bytes above
+    };
+
+    static constexpr std::uint32_t kNoRecord = 0xFFFFFFFFu;
+
+    static void fillRecord(Record& record, std::uint32_t slot, const ProfileManager::Slot& source);
+    static void sealHeader(Header& header, std::uint64_t committed, std::uint32_t slotCount);
+    bool verifyRecord(std::uint32_t slot) const;
+    bool mapFile();
+    void releaseMapping();
+    bool openForWrite();
+    bool writeAt(std::uint64_t offset, const void* data, std::size_t length);
+    bool syncFile();
+    void closeFile();
+    bool fail(const std::string& message);
+
+    ProfileManager* m_manager;
+    std::string m_path;
+    std::string m_error;
+
+    // File image kept for lazy checksum checks
+    const unsigned char* m_image;
+    std::size_t m_imageSize;
+    std::vector<unsigned char> m_buffer;    // image when mmap is unavailable
+    bool m_mapped;
+    std::vector<std::uint32_t> m_latest;    // slot -> newest record in the image
+
+    std::uint64_t m_committed;
+    int m_fd;
+};
+
+#endif // PROFILESTORE_H
@@ -0,0 +1,211 @@
+#include "cgmchartwidget.h"
+#include <QDateTime>
+#include <QPainter>
+#include <QPushButton>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <algorithm>
+#include "src/logic/handlertiming.h"
+
+namespace {
+QList<QPointF> toPoints(const std::vector<PyramidPoint>& in) {
+    QList<QPointF> out;
+    out.reserve(static_cast<int>(in.size()));
+    for (const PyramidPoint& p : in)
+        out.append(QPointF(p.timestampMs, p.value));
+    return out;
+}
+}
+
+CgmChartWidget::CgmChartWidget(QWidget* parent)
+    : QWidget(parent),
+    m_samples(kCapacity),
+    m_clockMs(QDateTime::currentMSecsSinceEpoch()),
+    m_spanMs(kPastWindowMs + kFutureWindowMs),
+    m_viewEndMs(0),
+    m_live(true)
+{
+    m_points = new QScatterSeries();
+    m_points->setMarkerSize(11);
+    m_points->setMarkerShape(QScatterSeries::MarkerShapeCircle);
+    m_points->setColor(Qt::black);
+    m_predicted = new QScatterSeries();
+    m_predicted->setMarkerSize(11);
+    m_predicted->setColor(Qt::gray);
+    m_line = new QSplineSeries();
+    m_line->setColor(Qt::blue);
+    m_nowLine = new QLineSeries();
+    m_nowLine->setColor(Qt::green);
+    // Zoomed-out views: bucket means plus a min/max band
+    m_overview = new QLineSeries();
+    m_overview->setColor(Qt::blue);
+    m_bandHigh = new QLineSeries();
+    m_bandLow = new QLineSeries();
+    m_band = new QAreaSeries(m_bandHigh, m_bandLow);
+    m_band->setColor(QColor(100, 149, 237, 80));
+    m_band->setBorderColor(Qt::transparent);
+
+    m_chart = new QChart();
+    m_chart->addSeries(m_band);
+    m_chart->addSeries(m_overview);
+    m_chart->addSeries(m_points);
+    m_chart->addSeries(m_predicted);
+    m_chart->addSeries(m_line);
+    m_chart->addSeries(m_nowLine);
+    m_chart->setTitle("CGM readings");
+    m_chart->legend()->setVisible(false);
+
+    m_axisX = new QDateTimeAxis();
+    m_axisX->setFormat("hh:mm");
+    m_axisX->setTickCount(9);
+    m_axisX->setTitleText("Time");
+    m_axisY = new QValueAxis();
+    m_axisY->setRange(2, 11);
+    m_axisY->setTitleText("Glucose Level (mmol/L)");
+    m_chart->addAxis(m_axisX, Qt::AlignBottom);
+    m_chart->addAxis(m_axisY, Qt::AlignLeft);
+    for (QAbstractSeries* series : m_chart->series()) {
+        series->attachAxis(m_axisX);
+        series->attachAxis(m_axisY);
+    }
+
+    m_chartView = new QChartView(m_chart, this);
+    m_chartView->setRenderHint(QPainter::Antialiasing);
+    m_chartView->setMinimumSize(QSize(500, 350));
+
+    // Zoom / pan controls
+    QPushButton* zoomOutButton = new QPushButton("-", this);
+    QPushButton* zoomInButton = new QPushButton("+", this);
+    QPushButton* backButton = new QPushButton("<", this);
+    QPushButton* forwardButton = new QPushButton(">", this);
+    QPushButton* liveButton = new QPushButton("Live", this);
+    m_spanLabel = new QLabel(this);
+    QHBoxLayout* controls = new QHBoxLayout();
+    controls->addWidget(zoomOutButton);
+    controls->addWidget(zoomInButton);
+    controls->addWidget(backButton);
+    controls->addWidget(forwardButton);
+    controls->addWidget(liveButton);
+    controls->addWidget(m_spanLabel);
+    controls->addStretch();
+    connect(zoomOutButton, &QPushButton::clicked, this, &CgmChartWidget::zoomOut);
+    connect(zoomInButton, &QPushButton::clicked, this, &CgmChartWidget::zoomIn);
+    connect(backButton, &QPushButton::clicked, this, &CgmChartWidget::panBack);
+    connect(forwardButton, &QPushButton::clicked, this, &CgmChartWidget::panForward);
+    connect(liveButton, &QPushButton::clicked, this, &CgmChartWidget::followLive);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(m_chartView);
+    layout->addLayout(controls);
+
+    // Coalesce readings into at most one chart update per frame
+    m_frameTimer = new QTimer(this);
+    m_frameTimer->setSingleShot(true);
+    m_frameTimer->setInterval(16);
+    connect(m_frameTimer, &QTimer::timeout, this, &CgmChartWidget::render);
+
+    render();
+}
+
+void CgmChartWidget::addReading(double glucose) {
+    PUMP_TIME_HANDLER("CgmChartWidget::addReading");
+    if (!m_samples.empty())
+        m_clockMs += kReadingStepMs;
+    m_samples.push({m_clockMs, glucose});
+    m_pyramid.add(m_clockMs, static_cast<float>(glucose));
+    scheduleRender();
+}
+
+void CgmChartWidget::zoomIn() {
+    m_spanMs = std::max(kMinSpanMs, m_spanMs / 2);
+    scheduleRender();
+}
+
+void CgmChartWidget::zoomOut() {
+    m_spanMs = std::min(kMaxSpanMs, m_spanMs * 2);
+    scheduleRender();
+}
+
+void CgmChartWidget::panBack() {
+    if (m_live)
+        m_viewEndMs = m_clockMs + m_spanMs / 4;
+    m_live = false;
+    m_viewEndMs -= m_spanMs / 2;
+    scheduleRender();
+}
+
+void CgmChartWidget::panForward() {
+    if (m_live)
+        return;
+    m_viewEndMs += m_spanMs / 2;
+    // Caught up with the newest reading: follow it again
+    if (m_viewEndMs >= m_clockMs + m_spanMs / 4)
+        m_live = true;
+    scheduleRender();
+}
+
+void CgmChartWidget::followLive() {
+    m_live = true;
+    scheduleRender();
+}
+
+qint64 CgmChartWidget::currentTime() const {
+    return m_clockMs;
+}
+
+void CgmChartWidget::scheduleRender() {
+    if (!m_frameTimer->isActive())
+        m_frameTimer->start();
+}
+
+void CgmChartWidget::render() {
+    PUMP_TIME_HANDLER("CgmChartWidget::render");
+    // Live view keeps the old 3:1 split between past and prediction
+    qint64 to = m_live ? m_clockMs + m_spanMs / 4 : m_viewEndMs;
+    qint64 from = to - m_spanMs;
+    PyramidView view = m_pyramid.query(from, to, kMaxPoints);
+
+    // Linear trend from the last three readings
+    QList<QPointF> predicted;
+    if (m_samples.size() >= 3) {
+        const CgmSample& s0 = m_samples.at(m_samples.size() - 1);
+        const CgmSample& s1 = m_samples.at(m_samples.size() - 2);
+        const CgmSample& s2 = m_samples.at(m_samples.size() - 3);
+        QPointF p0(s0.timestampMs, s0.glucose);
+        QPointF p1(s1.timestampMs, s1.glucose);
+        QPointF p2(s2.timestampMs, s2.glucose);
+        QPointF averageDiff = ((p1 - p0) + (p2 - p1)) * .5;
+        predicted.append(p0 - averageDiff);
+        predicted.append(p0 - 2 * averageDiff);
+        predicted.append(p0 - 3 * averageDiff);
+    }
+
+    QList<QPointF> points = toPoints(view.line);
+    if (view.raw) {
+        QList<QPointF> line = points;
+        line.append(predicted);
+        m_points->replace(points.size() <= static_cast<int>(kMaxMarkers) ? points : QList<QPointF>());
+        m_line->replace(line);
+        m_overview->replace(QList<QPointF>());
+    } else {
+        m_points->replace(QList<QPointF>());
+        m_line->replace(predicted);
+        m_overview->replace(points);
+    }
+    m_bandHigh->replace(toPoints(view.high));
+    m_bandLow->replace(toPoints(view.low));
+    m_predicted->replace(predicted);
+    m_nowLine->replace(QList<QPointF>{QPointF(m_clockMs, 0), QPointF(m_clockMs, 15)});
+
+    if (m_spanMs <= 24LL * 60 * 60 * 1000)
+        m_axisX->setFormat("hh:mm");
+    else if (m_spanMs <= 7LL * 24 * 60 * 60 * 1000)
+        m_axisX->setFormat("ddd hh:mm");
+    else
+        m_axisX->setFormat("MMM d");
+    m_axisX->setRange(QDateTime::fromMSecsSinceEpoch(from), QDateTime::fromMSecsSinceEpoch(to));
+
+    qint64 hours = m_spanMs / (60 * 60 * 1000);
+    m_spanLabel->setText(hours < 48 ? QString("%1 h").arg(hours) : QString("%1 days").arg(hours / 24));
+}
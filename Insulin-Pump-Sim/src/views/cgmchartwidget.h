@@ -0,0 +1,89 @@
+#ifndef CGMCHARTWIDGET_H
+#define CGMCHARTWIDGET_H
+
+#include <QWidget>
+#include <QTimer>
+#include <QLabel>
+#include <QtCharts/QAreaSeries>
+#include <QtCharts/QChart>
+#include <QtCharts/QChartView>
+#include <QtCharts/QDateTimeAxis>
+#include <QtCharts/QLineSeries>
+#include <QtCharts/QScatterSeries>
+#include <QtCharts/QSplineSeries>
+#include <QtCharts/QValueAxis>
+#include "src/logic/ringbuffer.h"
+#include "src/logic/cgmpyramid.h"
+
+QT_CHARTS_USE_NAMESPACE
+
+//--------------------------------------------------------
+// CGM CHART
+// Readings go into a fixed-capacity ring of timestamped
+// samples on a real time axis. The axis scrolls with the
+// newest reading instead of rewriting x values, and each
+// series gets one replace(QList) per frame, so an update
+// costs the same no matter how much history there is.
+// Zooming (1 h to 90 days) and panning draw from a CgmPyramid,
+// which keeps every frame under kMaxPoints points.
+//--------------------------------------------------------
+struct CgmSample {
+    qint64 timestampMs;
+    double glucose;
+};
+
+class CgmChartWidget : public QWidget {
+    Q_OBJECT
+public:
+    // Each reading advances the chart clock by 30 min (same pace as the old -0.5 h shift)
+    static constexpr qint64 kReadingStepMs = 30 * 60 * 1000;
+    static constexpr qint64 kPastWindowMs = 6 * 60 * 60 * 1000;
+    static constexpr qint64 kFutureWindowMs = 2 * 60 * 60 * 1000;
+    static constexpr int kCapacity = 64;
+    static constexpr qint64 kMinSpanMs = 60 * 60 * 1000;
+    static constexpr qint64 kMaxSpanMs = CgmPyramid::kRetentionMs;
+    static constexpr std::size_t kMaxPoints = 2000;
+    // Markers are only drawn for sparse raw views
+    static constexpr std::size_t kMaxMarkers = 200;
+
+    explicit CgmChartWidget(QWidget* parent = nullptr);
+
+    // Record a reading at the next chart time step
+    void addReading(double glucose);
+    qint64 currentTime() const;
+
+public slots:
+    void zoomIn();
+    void zoomOut();
+    void panBack();
+    void panForward();
+    void followLive();
+
+private:
+    void scheduleRender();
+    void render();
+
+    QChart* m_chart;
+    QChartView* m_chartView;
+    QDateTimeAxis* m_axisX;
+    QValueAxis* m_axisY;
+    QScatterSeries* m_points;
+    QScatterSeries* m_predicted;
+    QSplineSeries* m_line;
+    QLineSeries* m_nowLine;
+    QLineSeries* m_overview;
+    QLineSeries* m_bandHigh;
+    QLineSeries* m_bandLow;
+    QAreaSeries* m_band;
+    QLabel* m_spanLabel;
+    // Recent readings for the trend prediction
+    RingBuffer<CgmSample> m_samples;
+    CgmPyramid m_pyramid;
+    qint64 m_clockMs;
+    qint64 m_spanMs;
+    qint64 m_viewEndMs;
+    bool m_live;
+    QTimer* m_frameTimer;
+};
+
+#endif // CGMCHARTWIDGET_H
@@ -0,0 +1,155 @@
+#include "eventlogview.h"
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QDateTime>
+#include <algorithm>
+#include "src/logic/handlertiming.h"
+
+namespace {
+constexpr int kFrameMs = 16;
+}
+
+EventLogView::EventLogView(int maxLines, QWidget* parent)
+    : QPlainTextEdit(parent),
+    m_maxLines(maxLines),
+    m_suppressed(false),
+    m_dropped(0),
+    m_nextSerial(0),
+    m_shownCount(0)
+{
+    setReadOnly(true);
+    setMaximumBlockCount(m_maxLines);
+    setLineWrapMode(QPlainTextEdit::WidgetWidth);
+
+    m_flushTimer = new QTimer(this);
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(kFrameMs);
+    connect(m_flushTimer, &QTimer::timeout, this, &EventLogView::flush);
+}
+
+void EventLogView::appendMessages(const QStringList& messages) {
+    for (const QString& message : messages)
+        appendMessage(message);
+}
+
+void EventLogView::appendMessage(const QString& message) {
+    // One document block per line keeps shown lines addressable
+    QString text = message;
+    text.replace('\n', ' ');
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    for (auto it = m_recent.rbegin(); it != m_recent.rend(); ++it) {
+        if (it->text != text)
+            continue;
+        if (now - it->firstMs > kDedupMs)
+            break;  // stale, start a fresh line
+        it->count++;
+        if (it->shownIndex < 0)
+            m_pending[static_cast<std::size_t>(it->serial - m_pending.front().serial)].count = it->count;
+        else
+            it->dirty = true;
+        scheduleFlush();
+        return;
+    }
+
+    qint64 serial = m_nextSerial++;
+    m_pending.push_back({text, 1, serial});
+    m_recent.push_back({text, 1, serial, now, -1, false});
+    if (static_cast<int>(m_recent.size()) > kDedupLines) {
+        if (m_recent.front().dirty)
+            m_rewrites.push_back(m_recent.front());
+        m_recent.pop_front();
+    }
+    if (static_cast<int>(m_pending.size()) > m_maxLines) {
+        qint64 dropped = m_pending.front().serial;
+        m_pending.pop_front();
+        m_dropped++;
+        m_recent.erase(std::remove_if(m_recent.begin(), m_recent.end(),
+                                      [dropped](const Recent& r) { return r.serial == dropped; }),
+                       m_recent.end());
+    }
+    scheduleFlush();
+}
+
+void EventLogView::setSuppressed(bool suppressed) {
+    m_suppressed = suppressed;
+    if (!m_suppressed)
+        scheduleFlush();
+}
+
+bool EventLogView::isSuppressed() const {
+    return m_suppressed;
+}
+
+void EventLogView::clearLog() {
+    m_pending.clear();
+    m_recent.clear();
+    m_rewrites.clear();
+    m_shownCount = 0;
+    clear();
+}
+
+int EventLogView::maxLines() const {
+    return m_maxLines;
+}
+
+int EventLogView::droppedCount() const {
+    return m_dropped;
+}
+
+QString EventLogView::format(const QString& text, int count) {
+    if (count <= 1)
+        return text;
+    return text + QString("  (×%1)").arg(count);
+}
+
+void EventLogView::rewriteShown(const Recent& line) {
+    qint64 fromEnd = m_shownCount - 1 - line.shownIndex;
+    QTextBlock block = document()->findBlockByNumber(document()->blockCount() - 1 - static_cast<int>(fromEnd));
+    if (!block.isValid())
+        return;  // already trimmed by the block cap
+    QTextCursor cursor(block);
+    cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+    cursor.insertText(format(line.text, line.count));
+}
+
+void EventLogView::scheduleFlush() {
+    if (!m_suppressed && !m_flushTimer->isActive())
+        m_flushTimer->start();
+}
+
+void EventLogView::flush() {
+    PUMP_TIME_HANDLER("EventLogView::flush");
+    if (m_suppressed)
+        return;
+
+    // Repeats of lines already on screen: rewrite just those blocks
+    for (const Recent& line : m_rewrites)
+        rewriteShown(line);
+    m_rewrites.clear();
+    for (Recent& line : m_recent) {
+        if (line.dirty) {
+            rewriteShown(line);
+            line.dirty = false;
+        }
+    }
+
+    if (m_pending.empty())
+        return;
+
+    QStringList lines;
+    lines.reserve(static_cast<int>(m_pending.size()));
+    for (const Line& line : m_pending)
+        lines.append(format(line.text, line.count));
+    qint64 firstSerial = m_pending.front().serial;
+    for (Recent& line : m_recent) {
+        if (line.shownIndex < 0)
+            line.shownIndex = m_shownCount + (line.serial - firstSerial);
+    }
+    m_shownCount += static_cast<qint64>(m_pending.size());
+    m_pending.clear();
+
+    // One append, one relayout for the whole frame
+    appendPlainText(lines.join('\n'));
+}
@@ -0,0 +1,69 @@
+#ifndef EVENTLOGVIEW_H
+#define EVENTLOGVIEW_H
+
+#include <QPlainTextEdit>
+#include <QStringList>
+#include <QTimer>
+#include <deque>
+#include <vector>
+
+//--------------------------------------------------------
+// EVENT LOG VIEW (live log on the home screen)
+// Keeps at most maxLines() lines on screen, queues incoming
+// messages and flushes them in one append per frame, and
+// folds a repeat of any of the last kDedupLines distinct lines
+// (seen within kDedupMs) into a counter on that line, so an
+// alert interleaved with basal ticks still collapses. While
+// suppressed (alerts disabled) messages are held, up to the
+// same cap, and shown once the view is unsuppressed.
+//--------------------------------------------------------
+class EventLogView : public QPlainTextEdit {
+    Q_OBJECT
+public:
+    explicit EventLogView(int maxLines = 500, QWidget* parent = nullptr);
+
+    void appendMessages(const QStringList& messages);
+    void appendMessage(const QString& message);
+    void setSuppressed(bool suppressed);
+    bool isSuppressed() const;
+    void clearLog();
+    int maxLines() const;
+    // Messages discarded while held because the cap was reached
+    int droppedCount() const;
+
+private:
+    static constexpr int kDedupLines = 8;
+    static constexpr qint64 kDedupMs = 60 * 1000;
+
+    struct Line {
+        QString text;
+        int count;
+        qint64 serial;
+    };
+    // Recent distinct line that repeats fold into
+    struct Recent {
+        QString text;
+        int count;
+        qint64 serial;
+        qint64 firstMs;
+        qint64 shownIndex;  // -1 while still pending
+        bool dirty;         // on screen with a stale count
+    };
+
+    static QString format(const QString& text, int count);
+    void rewriteShown(const Recent& line);
+    void scheduleFlush();
+    void flush();
+
+    int m_maxLines;
+    bool m_suppressed;
+    int m_dropped;
+    std::deque<Line> m_pending;     // serials are contiguous
+    std::deque<Recent> m_recent;
+    std::vector<Recent> m_rewrites; // dirty lines that left the window
+    qint64 m_nextSerial;
+    qint64 m_shownCount;            // lines appended to the document
+    QTimer* m_flushTimer;
+};
+
+#endif // EVENTLOGVIEW_H
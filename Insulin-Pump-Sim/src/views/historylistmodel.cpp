@@ -0,0 +1,74 @@
+#include "historylistmodel.h"
+#include <QColor>
+
+HistoryListModel::HistoryListModel(DataManager* dataManager, QObject* parent)
+    : QAbstractListModel(parent),
+    m_dataManager(dataManager),
+    m_category(-1),
+    m_rowCount(0)
+{
+    m_rowCount = sourceCount();
+    m_dataManager->setAppendListener([this]() { eventsAppended(); });
+}
+
+HistoryListModel::~HistoryListModel() {
+    m_dataManager->setAppendListener(nullptr);
+}
+
+int HistoryListModel::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid())
+        return 0;
+    // Cached so views only ever see counts announced through beginInsertRows
+    return m_rowCount;
+}
+
+QVariant HistoryListModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= m_rowCount)
+        return QVariant();
+    int row = sourceRow(index.row());
+    if (role == Qt::DisplayRole || role == Qt::ToolTipRole)
+        return m_dataManager->eventAt(row);
+    if (role == Qt::ForegroundRole) {
+        switch (m_dataManager->categoryAt(row)) {
+        case EventCategory::System: return QColor(Qt::darkRed);
+        case EventCategory::Basal: return QColor(Qt::darkGreen);
+        case EventCategory::Bolus: return QColor(Qt::darkBlue);
+        default: break;
+        }
+    }
+    return QVariant();
+}
+
+void HistoryListModel::setCategoryFilter(int category) {
+    if (category == m_category)
+        return;
+    beginResetModel();
+    m_category = category;
+    m_rowCount = sourceCount();
+    endResetModel();
+}
+
+int HistoryListModel::categoryFilter() const {
+    return m_category;
+}
+
+int HistoryListModel::sourceCount() const {
+    if (m_category < 0)
+        return m_dataManager->eventCount();
+    return m_dataManager->eventsInCategory(static_cast<EventCategory>(m_category)).size();
+}
+
+int HistoryListModel::sourceRow(int row) const {
+    if (m_category < 0)
+        return row;
+    return m_dataManager->eventsInCategory(static_cast<EventCategory>(m_category)).at(row);
+}
+
+void HistoryListModel::eventsAppended() {
+    int count = sourceCount();
+    if (count <= m_rowCount)
+        return;
+    beginInsertRows(QModelIndex(), m_rowCount, count - 1);
+    m_rowCount = count;
+    endInsertRows();
+}
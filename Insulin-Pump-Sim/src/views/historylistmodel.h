@@ -0,0 +1,37 @@
+#ifndef HISTORYLISTMODEL_H
+#define HISTORYLISTMODEL_H
+
+#include <QAbstractListModel>
+#include "src/logic/datamanager.h"
+
+//--------------------------------------------------------
+// HISTORY LIST MODEL
+// Read-only list model over DataManager's event history.
+// Rows are appended incrementally as events are logged, and
+// a category filter maps rows through DataManager's
+// per-category index instead of copying the history.
+//--------------------------------------------------------
+class HistoryListModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    explicit HistoryListModel(DataManager* dataManager, QObject* parent = nullptr);
+    ~HistoryListModel();
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    // -1 shows every category
+    void setCategoryFilter(int category);
+    int categoryFilter() const;
+
+private:
+    int sourceCount() const;
+    int sourceRow(int row) const;
+    void eventsAppended();
+
+    DataManager* m_dataManager;
+    int m_category;
+    int m_rowCount;
+};
+
+#endif // HISTORYLISTMODEL_H
@@ -9,15 +9,23 @@
 #include <QMessageBox>
 #include <QDateTime>
 #include <QPainter>
-#include <QtCharts/QChartView>
 #include <QCheckBox>
 #include <QSpinBox>
 #include <QLabel>
 #include <QApplication>
+#include <QComboBox>
+#include <QListView>
+#include <cstdarg>
+#include <cstring>
 #include "src/dialogs/pindialog.h"
 #include "pumpsimulatormainwidget.h"
 #include "optionspagecontroller.h"
 #include "src/logic/insulindelivery.h"
+#include "src/logic/logger.h"
+#include "src/logic/handlertiming.h"
+#include "src/logic/simclock.h"
+#include "src/logic/controlserver.h"
+#include "timingoverlay.h"
 
 HomeScreenWidget::HomeScreenWidget(ProfileManager* profileManager,
                                    Battery* battery,
@@ -26,18 +34,45 @@ HomeScreenWidget::HomeScreenWidget(ProfileManager* profileManager,
                                    CGMSensor* sensor,
                                    QWidget* parent)
     : QWidget(parent),
+    m_historyView(nullptr),
+    m_historyModel(nullptr),
+    m_usageLabel(nullptr),
     m_profileManager(profileManager),
     m_battery(battery),
     m_cartridge(cartridge),
     m_iob(iob),
     m_sensor(sensor),
-    m_currentProfile(nullptr),
+    m_currentProfile(),
     m_chargingTimer(nullptr),
     m_basalButton(nullptr),
-    m_alertsEnabled(true)
+    m_optionsController(nullptr),
+    m_controlServer(nullptr)
 {
     // Event logging
     m_dataManager = new DataManager();
+    // Long-term trend history (compressed, months of readings)
+    m_trendStore.reset(new TimeSeriesStore());
+    // Dosing and model updates run here; the screen reads snapshots
+    m_delivery = new DeliveryThread(m_battery, m_cartridge, m_iob, m_sensor, this);
+
+    // Log lines reach the UI and history in batches from the logging thread
+    m_logSinkId = Logger::instance().addSink([this](const std::vector<LogEntry>& batch) {
+        QStringList lines;
+        QStringList stamped;
+        QVector<EventCategory> categories;
+        for (const LogEntry& entry : batch) {
+            if (entry.channel != LogChannel::Event)
+                continue;
+            lines.append(QString::fromStdString(entry.text));
+            stamped.append(QString::fromStdString(entry.stamped));
+            categories.append(DataManager::categorize(lines.last()));
+        }
+        if (lines.isEmpty())
+            return;
+        QMetaObject::invokeMethod(this, [this, lines, stamped, categories]() {
+            deliverLogBatch(lines, stamped, categories);
+        }, Qt::QueuedConnection);
+    });
 
 
     m_mainStackedWidget = new QStackedWidget(this);
@@ -46,44 +81,18 @@ HomeScreenWidget::HomeScreenWidget(ProfileManager* profileManager,
 
     // CGM graph and status layout.
     QVBoxLayout* statusLayout = new QVBoxLayout();
-    m_graph_points = new QScatterSeries();
-    m_graph_points->setMarkerSize(11);
-    m_graph_points->setMarkerShape(QScatterSeries::MarkerShapeCircle);
-    m_graph_points->setColor(Qt::black);
-    m_predicted_points = new QScatterSeries();
-    m_predicted_points->setMarkerSize(11);
-    m_graph_line = new QSplineSeries();
-    m_graph_line->setColor(Qt::blue);
-    QLineSeries* verticalLine = new QLineSeries();
-    verticalLine->append(0, 0);
-    verticalLine->append(0, 15);
-    verticalLine->setColor(Qt::green);
-    m_chart = new QChart();
-    m_chart->addSeries(m_graph_points);
-    m_chart->addSeries(m_predicted_points);
-    m_chart->addSeries(m_graph_line);
-    m_chart->addSeries(verticalLine);
-    m_chart->createDefaultAxes();
-    m_chart->setTitle("CGM readings");
-    m_chart->legend()->setVisible(false);
-    m_chart->axes()[0]->setRange(-6, 2);
-    m_chart->axes()[1]->setRange(2, 11);
-    m_chart->axes()[0]->setTitleText("Time (h)");
-    m_chart->axes()[1]->setTitleText("Glucose Level (mmol/L)");
-    QChartView* chartView = new QChartView(m_chart);
-    chartView->setRenderHint(QPainter::Antialiasing);
-    chartView->setMinimumSize(QSize(500, 350));
-    m_predicted_points->setColor(Qt::gray);
-    statusLayout->addWidget(chartView);
+    m_cgmChart = new CgmChartWidget(homePage);
+    statusLayout->addWidget(m_cgmChart);
 
 
 
     // Status boxes for Battery, Insulin, IOB, and CGM
     QHBoxLayout* boxDataLayout = new QHBoxLayout();
-    batteryBox = createStatusBox("Battery", QString::number(m_battery->getStatus()));
-    insulinBox = createStatusBox("Insulin", QString::number(m_cartridge->getInsulinLevel()));
-    iobBox     = createStatusBox("IOB", QString::number(m_iob->getIOB()));
-    cgmBox     = createStatusBox("CGM", QString::number(m_sensor->getGlucoseLevel()) + " mmol/L");
+    PumpSnapshot state = m_delivery->snapshot();
+    batteryBox = createStatusBox("Battery", QString::number(state.battery));
+    insulinBox = createStatusBox("Insulin", QString::number(state.insulin));
+    iobBox     = createStatusBox("IOB", QString::number(state.iob));
+    cgmBox     = createStatusBox("CGM", QString::number(state.glucose) + " mmol/L");
     boxDataLayout->addWidget(batteryBox);
     boxDataLayout->addWidget(insulinBox);
     boxDataLayout->addWidget(iobBox);
@@ -110,10 +119,9 @@ HomeScreenWidget::HomeScreenWidget(ProfileManager* profileManager,
 
     // Event log
     QGroupBox* logGroup = new QGroupBox("Event Log", homePage);
-    m_logTextEdit = new QTextEdit(homePage);
-    m_logTextEdit->setReadOnly(true);
+    m_logView = new EventLogView(500, homePage);
     QVBoxLayout* logLayout = new QVBoxLayout();
-    logLayout->addWidget(m_logTextEdit);
+    logLayout->addWidget(m_logView);
     logGroup->setLayout(logLayout);
 
     QHBoxLayout* profileAndLogLayout = new QHBoxLayout();
@@ -149,73 +157,72 @@ HomeScreenWidget::HomeScreenWidget(ProfileManager* profileManager,
     basalStatusLabel->setFixedHeight(30);
     homeLayout->addWidget(basalStatusLabel);
 
-    // History page
-    QWidget* historyPage = new QWidget(this);
-    QVBoxLayout* historyLayout = new QVBoxLayout(historyPage);
-    m_historyTextEdit = new QTextEdit(historyPage);
-    m_historyTextEdit->setReadOnly(true);
-    QPushButton* backFromHistory = new QPushButton("Back", historyPage);
-    historyLayout->addWidget(m_historyTextEdit);
-    historyLayout->addWidget(backFromHistory);
-
-    // Options button
-    m_optionsController = new OptionsPageController(this, m_profileManager);
-    QWidget* optionsPage = m_optionsController->getWidget();
+    // Home is shown right away; Options and History are built on first visit
+    m_navManager = new NavigationManager(m_mainStackedWidget);
+    m_navManager->registerPage("Home", [homePage]() { return homePage; });
+    m_navManager->registerPage("Options", [this]() { return buildOptionsPage(); });
+    m_navManager->registerPage("History", [this]() { return buildHistoryPage(); });
+    m_navManager->navigateToHome();
 
-    // Add pages to the stacked widget: Home (index 0), Options (index 1), History (index 2)
-    m_mainStackedWidget->addWidget(homePage);
-    m_mainStackedWidget->addWidget(optionsPage);
-    m_mainStackedWidget->addWidget(historyPage);
+#ifdef PUMP_INSTRUMENTATION
+    // Handler latency readout (Ctrl+Shift+T)
+    new TimingOverlay(this);
+#endif
 
     // navigation to different views
-    m_navManager = new NavigationManager(m_mainStackedWidget);
     connect(bolusButton, &QPushButton::clicked, this, &HomeScreenWidget::onBolus);
     connect(optionsButton, &QPushButton::clicked, this, [this]() {
-        updateOptionsPage();
+        PUMP_TIME_HANDLER("HomeScreenWidget::optionsClicked");
         m_navManager->navigateToOptions();
+        updateOptionsPage();
     });
-    connect(historyButton, &QPushButton::clicked, this, [this]() { updateHistory(); m_navManager->navigateToHistory(); });
+    connect(historyButton, &QPushButton::clicked, this, [this]() { m_navManager->navigateToHistory(); updateHistory(); });
     connect(chargeButton, &QPushButton::clicked, this, &HomeScreenWidget::onCharge);
     connect(m_basalButton, &QPushButton::clicked, this, &HomeScreenWidget::toggleBasalDelivery);
     connect(disconnectButton, &QPushButton::clicked, this, [this, disconnectButton]() {
-        if(m_sensor->isConnected()){
-            m_sensor->disconnectSensor();
-            disconnectButton->setText("Toggle CGM Reconnect");
-            addLog("Simulated CGM disconnect.");
-        } else {
-            m_sensor->connectSensor();
-            disconnectButton->setText("Toggle CGM Disconnect");
-            addLog("Simulated CGM reconnected.");
-        }
-        updateStatus();
+        PUMP_TIME_HANDLER("HomeScreenWidget::disconnectToggled");
+        m_delivery->post([this, disconnectButton]() {
+            bool connected = m_sensor->isConnected();
+            if(connected){
+                m_sensor->disconnectSensor();
+                addLog("Simulated CGM disconnect.");
+            } else {
+                m_sensor->connectSensor();
+                addLog("Simulated CGM reconnected.");
+            }
+            m_delivery->toUi([disconnectButton, connected]() {
+                disconnectButton->setText(connected ? "Toggle CGM Reconnect" : "Toggle CGM Disconnect");
+            });
+        });
     });
     connect(occlusionButton, &QPushButton::clicked, this, [this, occlusionButton]() {
-        if(!m_cartridge->isOccluded()){
-            m_cartridge->setOcclusion(true);
-            occlusionButton->setText("Clear Occlusion");
-            addLog("Simulated Occlusion detected.");
-        } else {
-            m_cartridge->setOcclusion(false);
-            occlusionButton->setText("Toggle Occlusion");
-            addLog("Simulated Occlusion cleared.");
-        }
-        updateStatus();
+        PUMP_TIME_HANDLER("HomeScreenWidget::occlusionToggled");
+        m_delivery->post([this, occlusionButton]() {
+            bool occluded = !m_cartridge->isOccluded();
+            m_cartridge->setOcclusion(occluded);
+            addLog(occluded ? "Simulated Occlusion detected." : "Simulated Occlusion cleared.");
+            m_delivery->toUi([occlusionButton, occluded]() {
+                occlusionButton->setText(occluded ? "Clear Occlusion" : "Toggle Occlusion");
+            });
+        });
     });
-    connect(backFromHistory, &QPushButton::clicked, this, [this]() { m_navManager->navigateToHome(); });
 
     QVBoxLayout* mainLayoutWidget = new QVBoxLayout(this);
     mainLayoutWidget->addWidget(m_mainStackedWidget);
     setLayout(mainLayoutWidget);
 
-    // IOB decay timer
-    QTimer* iobDecayTimer = new QTimer(this);
-    connect(iobDecayTimer, &QTimer::timeout, this, [this]() {
-        if (m_iob && m_iob->isActive()) {
-            m_iob->decay();  // silently reduce IOB
-            updateStatus();  // update display
-        }
+    // IOB decay timer (on the delivery thread)
+    m_delivery->post([this]() {
+        QTimer* iobDecayTimer = new QTimer(m_delivery->context());
+        connect(iobDecayTimer, &QTimer::timeout, m_delivery->context(), [this]() {
+            PUMP_TIME_HANDLER("HomeScreenWidget::iobDecayTimer");
+            if (m_iob && m_iob->isActive()) {
+                m_iob->decay();  // silently reduce IOB
+                m_delivery->publish();  // update display
+            }
+        });
+        iobDecayTimer->start(20000);  // every 20 seconds
     });
-    iobDecayTimer->start(20000);  // every 20 seconds
 
     // Crash button connection
     connect(crashButton, &QPushButton::clicked, this, &HomeScreenWidget::onCrashInsulin);
@@ -223,10 +230,177 @@ HomeScreenWidget::HomeScreenWidget(ProfileManager* profileManager,
     connect(editProfileButton, &QPushButton::clicked, this, &HomeScreenWidget::onEditProfile);
     connect(deleteProfileButton, &QPushButton::clicked, this, &HomeScreenWidget::onDeleteProfile);
 
+    // Get InsulinDeliveryController
+    m_insulinDelivery = new InsulinDelivery(
+        m_profileManager,
+        m_currentProfile, // Find the HomeScreenWidget’s current profile handle
+        m_battery,
+        m_cartridge,
+        m_iob,
+        m_sensor,
+        m_dataManager,
+        m_delivery,
+        [this](const QString &msg){ addLog(msg); },
+        [this](const QString &status){ basalStatusLabel->setText(status); },
+        this
+        );
+
+    m_delivery->setPublishedCallback([this]() { updateStatus(); });
+    m_delivery->setBasalCallback([this](const BasalSample& sample) {
+        if (!m_dataManager)
+            return;
+        m_dataManager->recordBasal(sample.units);
+        m_dataManager->recordGlucose(sample.glucose);
+    });
+    // PUMP_TELEMETRY_SHM=/name -> live state for external dashboards
+    QString telemetry = qEnvironmentVariable("PUMP_TELEMETRY_SHM");
+    if (!telemetry.isEmpty() && !m_delivery->openTelemetry(telemetry.toStdString()))
+        addLog("[SYSTEM] Telemetry segment failed: " + telemetry);
+    m_delivery->start();
+    startCgmFeed();
+    startControlServer(chargeButton, disconnectButton, occlusionButton);
+}
+
+// PUMP_CGM_FEED=synthetic, or a dataset file to replay (see CgmImportReader)
+void HomeScreenWidget::startCgmFeed() {
+    QString feed = qEnvironmentVariable("PUMP_CGM_FEED");
+    if (feed.isEmpty())
+        return;
+    const std::int64_t readingSimMs = 5 * 60 * 1000;   // one reading every 5 sensor minutes
+    bool synthetic = feed == "synthetic";
+    if (!synthetic) {
+        // The usage summary covers the whole dataset up front
+        TraceCache trace;
+        if (trace.load(feed.toStdString())) {
+            m_dataManager->recordTrace(trace);
+            addLogf("[CGM] Dataset: %zu readings (%s)", trace.rows(), trace.rebuilt() ? "imported" : "cached");
+        }
+    }
+    CgmIngest::Source source = synthetic
+        ? CgmIngest::synthetic(7.0f, 2.5f, 24 * 60 * 60 * 1000, readingSimMs)
+        : CgmIngest::replay(feed.toStdString());
+    m_delivery->startCgmFeed(source, SimClock::toReal(readingSimMs), [this, synthetic](const CgmIngest::Batch& batch) {
+        m_delivery->toUi([this, batch, synthetic]() {
+            for (const CgmReading& reading : batch.backfill) {
+                if (synthetic)
+                    m_dataManager->recordGlucose(reading.mmol);
+                m_cgmChart->addReading(reading.mmol);
+            }
+            if (synthetic) {
+                for (const CgmReading& reading : batch.live)
+                    m_dataManager->recordGlucose(reading.mmol);
+            }
+            if (!batch.backfill.empty())
+                addLogf("[CGM] Backfilled %zu readings missed while disconnected.", batch.backfill.size());
+        });
+    });
+    addLog("[CGM] Sensor feed started: " + feed);
+}
+
+// PUMP_CONTROL_SOCKET=<name> -> local socket API for test harnesses.
+// Toggles click the same buttons a user would; dialog-driven
+// actions use their headless halves.
+void HomeScreenWidget::startControlServer(QPushButton* chargeButton, QPushButton* disconnectButton,
+                                          QPushButton* occlusionButton) {
+    QString name = qEnvironmentVariable("PUMP_CONTROL_SOCKET");
+    if (name.isEmpty())
+        return;
+    m_controlServer = new ControlServer(m_delivery, this);
+    auto toggle = [](QPushButton* button) {
+        return [button](const QStringList&) { button->click(); return QString(); };
+    };
+    auto number = [](const QStringList& args, int i, bool& ok) {
+        return ok ? args.value(i).toFloat(&ok) : 0.0f;
+    };
+    m_controlServer->addCommand("charge", toggle(chargeButton));
+    m_controlServer->addCommand("disconnect", toggle(disconnectButton));
+    m_controlServer->addCommand("occlusion", toggle(occlusionButton));
+    m_controlServer->addCommand("basal", [this](const QStringList&) {
+        if (!currentProfile())
+            return QString("no profile loaded");
+        toggleBasalDelivery();
+        return QString();
+    });
+    m_controlServer->addCommand("bolus", [this, number](const QStringList& args) {
+        bool ok = true;
+        float units = number(args, 0, ok);
+        if (!ok || units <= 0.0f)
+            return QString("usage: bolus <units>");
+        m_insulinDelivery->deliverBolus(units);
+        return QString();
+    });
+    m_controlServer->addCommand("profile", [this, number](const QStringList& args) {
+        QString action = args.value(0);
+        bool ok = true;
+        if (action == "create" && args.size() == 6) {
+            float basal = number(args, 2, ok), carb = number(args, 3, ok);
+            float correction = number(args, 4, ok), target = number(args, 5, ok);
+            return ok ? createProfile(args[1], basal, carb, correction, target) : QString("bad number");
+        }
+        if (action == "edit" && args.size() == 5) {
+            float basal = number(args, 1, ok), carb = number(args, 2, ok);
+            float correction = number(args, 3, ok), target = number(args, 4, ok);
+            return ok ? editProfile(basal, carb, correction, target) : QString("bad number");
+        }
+        if (action == "delete")
+            return deleteProfile();
+        if (action == "switch" && args.size() == 2) {
+            if (!m_profileManager->findProfile(args[1].toStdString()).isValid())
+                return "no profile named " + args[1];
+            switchProfile(args[1]);
+            return QString();
+        }
+        return QString("usage: profile create <name> <basal> <carb> <correction> <target> | "
+                       "edit <basal> <carb> <correction> <target> | delete | switch <name>");
+    });
+    m_controlServer->addCommand("crash", [this](const QStringList&) {
+        crash();
+        return QString();
+    });
+    if (m_controlServer->listen(name))
+        addLog("[SYSTEM] Control socket listening: " + name);
+    else
+        addLog("[SYSTEM] Control socket failed: " + m_controlServer->errorString());
+}
+
+// History page -> only the visible rows of the history get laid out
+QWidget* HomeScreenWidget::buildHistoryPage() {
+    QWidget* historyPage = new QWidget(this);
+    QVBoxLayout* historyLayout = new QVBoxLayout(historyPage);
+    m_historyModel = new HistoryListModel(m_dataManager, this);
+    m_historyView = new QListView(historyPage);
+    m_historyView->setModel(m_historyModel);
+    m_historyView->setUniformItemSizes(true);
+    m_historyView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    QComboBox* historyFilter = new QComboBox(historyPage);
+    historyFilter->addItem("All events", -1);
+    for (int c = 0; c < static_cast<int>(EventCategory::Count); c++)
+        historyFilter->addItem(DataManager::categoryName(static_cast<EventCategory>(c)), c);
+    connect(historyFilter, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this, historyFilter](int) {
+        PUMP_TIME_HANDLER("HomeScreenWidget::historyFilterChanged");
+        m_historyModel->setCategoryFilter(historyFilter->currentData().toInt());
+        m_historyView->scrollToBottom();
+    });
+    m_usageLabel = new QLabel(historyPage);
+    m_usageLabel->setFrameStyle(QFrame::Panel | QFrame::Sunken);
+    QPushButton* backFromHistory = new QPushButton("Back", historyPage);
+    historyLayout->addWidget(m_usageLabel);
+    historyLayout->addWidget(historyFilter);
+    historyLayout->addWidget(m_historyView);
+    historyLayout->addWidget(backFromHistory);
+    connect(backFromHistory, &QPushButton::clicked, this, [this]() { m_navManager->navigateToHome(); });
+    return historyPage;
+}
+
+// Options page -> built on first visit
+QWidget* HomeScreenWidget::buildOptionsPage() {
+    m_optionsController = new OptionsPageController(this, m_profileManager);
     // OptionsPageController connections like PIN changed and sleep mode
     connect(m_optionsController, &OptionsPageController::alertToggled, this, [this](bool disabled){
+        PUMP_TIME_HANDLER("HomeScreenWidget::alertToggled");
         addLog(disabled ? "[ALERT] 🔕 Alerts disabled" : "[ALERT] 🔔 Alerts enabled");
-        m_alertsEnabled = !disabled;
+        // Held lines show up again once alerts are back on
+        m_logView->setSuppressed(disabled);
     });
     connect(m_optionsController, &OptionsPageController::changePinRequested, this, [this](){
         PINDialog dlg(PinMode::Set, "", this);
@@ -240,8 +414,9 @@ HomeScreenWidget::HomeScreenWidget(ProfileManager* profileManager,
         }
     });
     connect(m_optionsController, &OptionsPageController::sleepModeToggled, this, [this](bool enabled, int timeout){
+        PUMP_TIME_HANDLER("HomeScreenWidget::sleepModeToggled");
         if(enabled) {
-            addLog(QString("[SLEEP MODE] Enabled. Will activate after %1 seconds of inactivity.").arg(timeout));
+            addLogf("[SLEEP MODE] Enabled. Will activate after %d seconds of inactivity.", timeout);
             QTimer::singleShot(timeout * 1000, this, [this](){
                 addLog("[SLEEP MODE] Pump is now in sleep mode.");
                 setEnabled(false);
@@ -265,26 +440,31 @@ HomeScreenWidget::HomeScreenWidget(ProfileManager* profileManager,
     connect(m_optionsController, &OptionsPageController::backClicked, this, [this](){
         m_navManager->navigateToHome();
     });
+    connect(m_optionsController, &OptionsPageController::profileSwitchRequested, this, &HomeScreenWidget::switchProfile);
+    return m_optionsController->getWidget();
+}
 
-    // Get InsulinDeliveryController
-    m_insulinDelivery = new InsulinDelivery(
-        m_currentProfile, // Find the HomeScreenWidget’s current profile pointer
-        m_battery,
-        m_cartridge,
-        m_iob,
-        m_sensor,
-        [this](const QString &msg){ addLog(msg); },
-        [this](){ updateStatus(); },
-        [this](const QString &status){ basalStatusLabel->setText(status); },
-        this
-        );
+HomeScreenWidget::~HomeScreenWidget() {
+    // Join before the members the delivery thread uses go away
+    m_delivery->stop();
+    Logger::instance().removeSink(m_logSinkId);
 }
 
 void HomeScreenWidget::updateStatus() {
-    batteryBox->setText("Battery\n" + QString::number(m_battery->getStatus()));
-    insulinBox->setText("Insulin\n" + QString::number(m_cartridge->getInsulinLevel()));
-    iobBox->setText("IOB\n" + QString::number(m_iob->getIOB()));
-    cgmBox->setText("CGM\n" + QString::number(m_sensor->getGlucoseLevel()) + " mmol/L");
+    PUMP_TIME_HANDLER("HomeScreenWidget::updateStatus");
+    PumpSnapshot state = m_delivery->snapshot();
+    batteryBox->setText("Battery\n" + QString::number(state.battery));
+    insulinBox->setText("Insulin\n" + QString::number(state.insulin));
+    iobBox->setText("IOB\n" + QString::number(state.iob));
+    cgmBox->setText("CGM\n" + QString::number(state.glucose) + " mmol/L");
+    if (m_controlServer)
+        m_controlServer->publishState();
+    // Same pump time as the usage stats shown next to the trend
+    m_trendStore->recordAll(m_dataManager->simNowMs(),
+                            state.glucose,
+                            state.iob,
+                            state.insulin,
+                            state.battery);
     updateGraph();
 }
 
@@ -297,58 +477,75 @@ void HomeScreenWidget::onCreateProfile() {
         if(name.trimmed().isEmpty()){
             return;
         }
-        float basal = dlg.getBasalRate();
-        float carb = dlg.getCarbRatio();
-        float correction = dlg.getCorrectionFactor();
-        float target = dlg.getTargetGlucose();
-        Profile newProfile(name.toStdString(), basal, carb, correction, target);
-        m_profileManager->createProfile(newProfile);
-        m_currentProfile = m_profileManager->selectProfile(name.toStdString());
-        updateProfileDisplay();
-        m_logTextEdit->clear();
-        addLog("[PROFILE] Created profile: " + name);
+        QString error = createProfile(name, dlg.getBasalRate(), dlg.getCarbRatio(),
+                                      dlg.getCorrectionFactor(), dlg.getTargetGlucose());
+        if(!error.isEmpty())
+            QMessageBox::warning(this, "Create Profile", error);
     }
 }
 
+QString HomeScreenWidget::createProfile(const QString& name, float basal, float carb, float correction, float target) {
+    Profile newProfile(name.toStdString(), basal, carb, correction, target);
+    ProfileHandle handle = m_profileManager->createProfile(newProfile);
+    if(!handle.isValid())
+        return "A profile named \"" + name + "\" already exists or the name is too long.";
+    m_currentProfile = handle;
+    updateProfileDisplay();
+    m_logView->clearLog();
+    addLogf("[PROFILE] Created profile: %s", newProfile.getName().c_str());
+    return QString();
+}
+
 
 //edits profile and information
 void HomeScreenWidget::onEditProfile() {
-    if(!m_currentProfile) {
+    Profile* profile = currentProfile();
+    if(!profile) {
         QMessageBox::warning(this, "Edit Profile", "No profile loaded to edit.");
         return;
     }
-    NewProfileDialog dlg(QString::fromStdString(m_currentProfile->getName()),
-                         m_currentProfile->getBasalRate(),
-                         m_currentProfile->getCarbRatio(),
-                         m_currentProfile->getCorrectionFactor(),
-                         m_currentProfile->getTargetGlucose(),
+    NewProfileDialog dlg(QString::fromStdString(profile->getName()),
+                         profile->getBasalRate(),
+                         profile->getCarbRatio(),
+                         profile->getCorrectionFactor(),
+                         profile->getTargetGlucose(),
                          this);
-    if(dlg.exec() == QDialog::Accepted) {
-        m_currentProfile->updateSettings(dlg.getBasalRate(),
-                                         dlg.getCarbRatio(),
-                                         dlg.getCorrectionFactor(),
-                                         dlg.getTargetGlucose());
-        updateProfileDisplay();
-        addLog("[PROFILE] Updated profile: " + QString::fromStdString(m_currentProfile->getName()));
-    }
+    if(dlg.exec() == QDialog::Accepted)
+        editProfile(dlg.getBasalRate(), dlg.getCarbRatio(), dlg.getCorrectionFactor(), dlg.getTargetGlucose());
+}
+
+QString HomeScreenWidget::editProfile(float basal, float carb, float correction, float target) {
+    if(!m_profileManager->updateProfile(m_currentProfile, basal, carb, correction, target))
+        return "No profile loaded to edit.";
+    updateProfileDisplay();
+    addLogf("[PROFILE] Updated profile: %s", currentProfile()->getName().c_str());
+    return QString();
 }
 
 //delete profile
 void HomeScreenWidget::onDeleteProfile() {
-    if(!m_currentProfile) {
+    Profile* profile = currentProfile();
+    if(!profile) {
         QMessageBox::warning(this, "Delete Profile", "No profile loaded to delete.");
         return;
     }
     int ret = QMessageBox::question(this, "Delete Profile",
                                     "Are you sure you want to delete the current profile?",
                                     QMessageBox::Yes | QMessageBox::No);
-    if(ret == QMessageBox::Yes) {
-        addLog("[PROFILE] Deleted profile: " + QString::fromStdString(m_currentProfile->getName()));
-        m_profileManager->deleteProfile(m_currentProfile->getName());
-        m_currentProfile = nullptr;
-        updateProfileDisplay();
-        m_logTextEdit->clear();
-    }
+    if(ret == QMessageBox::Yes)
+        deleteProfile();
+}
+
+QString HomeScreenWidget::deleteProfile() {
+    Profile* profile = currentProfile();
+    if(!profile)
+        return "No profile loaded to delete.";
+    addLogf("[PROFILE] Deleted profile: %s", profile->getName().c_str());
+    m_profileManager->deleteProfile(m_currentProfile);
+    m_currentProfile = ProfileHandle();
+    updateProfileDisplay();
+    m_logView->clearLog();
+    return QString();
 }
 
 
@@ -360,6 +557,7 @@ void HomeScreenWidget::onBolus() {
 
 //check the charge
 void HomeScreenWidget::onCharge() {
+    PUMP_TIME_HANDLER("HomeScreenWidget::onCharge");
     QPushButton* chargeButton = qobject_cast<QPushButton*>(sender());
     if (!chargeButton)
         return;
@@ -375,9 +573,9 @@ void HomeScreenWidget::onCharge() {
     addLog("[SYSTEM] 🔌 Charging started...");
     m_chargingTimer = new QTimer(this);
     connect(m_chargingTimer, &QTimer::timeout, this, [=]() {
-        if (m_battery->getStatus() < 100) {
-            m_battery->charge();
-            updateStatus();
+        PUMP_TIME_HANDLER("HomeScreenWidget::chargingTimer");
+        if (m_delivery->snapshot().battery < 100) {
+            m_delivery->post([this]() { m_battery->charge(); });
         } else {
             m_chargingTimer->stop();
             m_chargingTimer->deleteLater();
@@ -392,7 +590,8 @@ void HomeScreenWidget::onCharge() {
 
 //get basal delivery -> stop start reums pause
 void HomeScreenWidget::toggleBasalDelivery() {
-    if (!m_currentProfile) {
+    PUMP_TIME_HANDLER("HomeScreenWidget::toggleBasalDelivery");
+    if (!currentProfile()) {
         QMessageBox::warning(this, "Basal Delivery", "No profile loaded.");
         return;
     }
@@ -404,51 +603,57 @@ void HomeScreenWidget::startBasalDelivery() {
 }
 
 void HomeScreenWidget::updateProfileDisplay() {
-    if(m_currentProfile) {
+    PUMP_TIME_HANDLER("HomeScreenWidget::updateProfileDisplay");
+    Profile* profile = currentProfile();
+    if(profile) {
         currentProfileLabel->setText(
-            "Current Profile: \"" + QString::fromStdString(m_currentProfile->getName()) + "\"\n"
-                                                                                          "   - Basal Rate: " + QString::number(m_currentProfile->getBasalRate()) + " u/hr\n"
-                                                                  "   - Carb Ratio: 1u per " + QString::number(static_cast<int>(m_currentProfile->getCarbRatio())) + " g\n"
-                                                                                    "   - Correction Factor: 1u per " + QString::number(static_cast<int>(m_currentProfile->getCorrectionFactor())) + " mmol/L\n"
-                                                                                           "   - Target BG: " + QString::number(m_currentProfile->getTargetGlucose()) + " mmol/L"
+            "Current Profile: \"" + QString::fromStdString(profile->getName()) + "\"\n"
+                                                                                          "   - Basal Rate: " + QString::number(profile->getBasalRate()) + " u/hr\n"
+                                                                  "   - Carb Ratio: 1u per " + QString::number(static_cast<int>(profile->getCarbRatio())) + " g\n"
+                                                                                    "   - Correction Factor: 1u per " + QString::number(static_cast<int>(profile->getCorrectionFactor())) + " mmol/L\n"
+                                                                                           "   - Target BG: " + QString::number(profile->getTargetGlucose()) + " mmol/L"
             );
         m_insulinDelivery->setCurrentProfile(m_currentProfile);
     } else {
         currentProfileLabel->setText("No profile loaded.");
     }
+    // A running basal follows edits / deletion of its profile
+    m_insulinDelivery->syncProfile();
 }
 
 
 //add to the history logging
 void HomeScreenWidget::updateHistory() {
-    if(m_dataManager && m_historyTextEdit)
-        m_historyTextEdit->setText(m_dataManager->getHistory());
+    PUMP_TIME_HANDLER("HomeScreenWidget::updateHistory");
+    // The model already holds every event; just jump to the newest
+    if(m_historyView)
+        m_historyView->scrollToBottom();
+    if(m_dataManager && m_usageLabel)
+        m_usageLabel->setText(m_dataManager->analyzeUsage() + "\n" + trendSummary());
 }
 
-//graph
+// Last 24 pump hours from the compressed trend store (block summaries, no full decode)
+QString HomeScreenWidget::trendSummary() const {
+    const qint64 dayMs = 24LL * 60 * 60 * 1000;
+    qint64 now = m_dataManager->simNowMs();
+    TimeSeriesAggregate cgm = m_trendStore->series(PumpChannel::Cgm).aggregate(now - dayMs, now);
+    if (cgm.count == 0)
+        return "Trend: no readings yet";
+    TimeSeriesAggregate iob = m_trendStore->series(PumpChannel::Iob).aggregate(now - dayMs, now);
+    TimeSeriesAggregate battery = m_trendStore->series(PumpChannel::Battery).aggregate(now - dayMs, now);
+    return QString("Trend 24 h: CGM %1 mmol/L (%2-%3) | peak IOB %4 u | battery low %5% | %6 KB stored")
+        .arg(cgm.mean(), 0, 'f', 1)
+        .arg(cgm.min, 0, 'f', 1)
+        .arg(cgm.max, 0, 'f', 1)
+        .arg(iob.max, 0, 'f', 2)
+        .arg(battery.min, 0, 'f', 0)
+        .arg(m_trendStore->compressedBytes() / 1024.0, 0, 'f', 1);
+}
+
+//graph -> the chart redraws at most once per frame
 void HomeScreenWidget::updateGraph() {
-    for (int i = 0; i < m_graph_points->count(); i++) {
-        QPointF cur = m_graph_points->at(i);
-        if (cur.x() < -6) {
-            m_graph_points->remove(i);
-            continue;
-        }
-        m_graph_points->replace(i, cur.x() - .5, cur.y());
-    }
-    m_graph_points->append(QPointF(0, m_sensor->getGlucoseLevel()));
-    m_predicted_points->clear();
-    if (m_graph_points->count() >= 3) {
-        QPointF p0 = m_graph_points->at(m_graph_points->count() - 1);
-        QPointF p1 = m_graph_points->at(m_graph_points->count() - 2);
-        QPointF p2 = m_graph_points->at(m_graph_points->count() - 3);
-        QPointF averageDiff = ((p1 - p0) + (p2 - p1)) * .5;
-        m_predicted_points->append(p0 - averageDiff);
-        m_predicted_points->append(p0 - 2 * averageDiff);
-        m_predicted_points->append(p0 - 3 * averageDiff);
-    }
-    m_graph_line->clear();
-    m_graph_line->append(m_graph_points->points());
-    m_graph_line->append(m_predicted_points->points());
+    PUMP_TIME_HANDLER("HomeScreenWidget::updateGraph");
+    m_cgmChart->addReading(m_delivery->snapshot().glucose);
 }
 
 
@@ -471,32 +676,67 @@ QLabel* HomeScreenWidget::createStatusBox(const QString& title, const QString& v
 
 //
 void HomeScreenWidget::updateOptionsPage() {
-    m_optionsController->updateProfileSwitching(m_profileManager->getProfiles(), m_currentProfile,
-                                                [this](const Profile& profile) {
-                                                    m_currentProfile = m_profileManager->selectProfile(profile.getName());
-                                                    updateProfileDisplay();
-                                                    addLog("[PROFILE] Switched to profile: " + QString::fromStdString(profile.getName()));
-                                                    m_navManager->navigateToHome();
-                                                }
-                                                );
+    PUMP_TIME_HANDLER("HomeScreenWidget::updateOptionsPage");
+    if (m_optionsController)
+        m_optionsController->setCurrentProfile(currentProfile());
+}
+
+Profile* HomeScreenWidget::currentProfile() const {
+    return m_profileManager->get(m_currentProfile);
+}
+
+void HomeScreenWidget::switchProfile(const QString& name) {
+    PUMP_TIME_HANDLER("HomeScreenWidget::switchProfile");
+    ProfileHandle handle = m_profileManager->findProfile(name.toStdString());
+    if (!m_profileManager->selectProfile(handle)) {
+        addLog("[PROFILE] Profile could not be loaded (damaged record).");
+        return;
+    }
+    m_currentProfile = handle;
+    updateProfileDisplay();
+    addLogf("[PROFILE] Switched to profile: %s", currentProfile()->getName().c_str());
+    m_navManager->navigateToHome();
 }
 
 
 //simualation to crash insulin
 void HomeScreenWidget::onCrashInsulin() {
+    crash();
+    QMessageBox::critical(this, "System Crash", "All insulin delivery has been stopped due to a critical error.");
+}
+
+
+
+void HomeScreenWidget::crash() {
     addLog("[SYSTEM]: ❌ Crash -> Stopping all insulin delivery");
     m_insulinDelivery->stopAllDelivery();
     m_basalButton->setText("Start Basal Delivery");
     basalStatusLabel->setText("Basal stopped (System Crash)");
-    QMessageBox::critical(this, "System Crash", "All insulin delivery has been stopped due to a critical error.");
 }
 
+//adding the logs
+void HomeScreenWidget::addLog(const char* message) {
+    Logger::instance().log(LogChannel::Event, message, std::strlen(message));
+}
 
+void HomeScreenWidget::addLogf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    Logger::instance().vlogf(LogChannel::Event, format, args);
+    va_end(args);
+}
 
-//adding the logs
 void HomeScreenWidget::addLog(const QString& message) {
-    if(m_alertsEnabled)
-        m_logTextEdit->append(message);
+    PUMP_TIME_HANDLER("HomeScreenWidget::addLog");
+    QByteArray utf8 = message.toUtf8();
+    Logger::instance().log(LogChannel::Event, utf8.constData(), utf8.size());
+}
+
+//batch of log lines from the logging thread
+void HomeScreenWidget::deliverLogBatch(const QStringList& lines, const QStringList& stamped,
+                                       const QVector<EventCategory>& categories) {
+    PUMP_TIME_HANDLER("HomeScreenWidget::deliverLogBatch");
+    m_logView->appendMessages(lines);
     if(m_dataManager)
-        m_dataManager->logEvent(message);
+        m_dataManager->logFormattedEvents(stamped, categories);
 }
@@ -6,11 +6,10 @@
 #include <QTextEdit>
 #include <QTimer>
 #include <QStackedWidget>
-#include <QtCharts/QChart>
-#include <QtCharts/QScatterSeries>
-#include <QtCharts/QSplineSeries>
+#include <QListView>
 #include <QtWidgets/qboxlayout.h>
 #include <QtWidgets/qpushbutton.h>
+#include <memory>
 #include "src/models/profilemanager.h"
 #include "src/models/battery.h"
 #include "src/models/insulincartridge.h"
@@ -18,10 +17,15 @@
 #include "src/models/cgmsensor.h"
 #include "src/logic/navigationmanager.h"
 #include "src/logic/datamanager.h"
+#include "src/logic/timeseriesstore.h"
+#include "historylistmodel.h"
+#include "eventlogview.h"
+#include "cgmchartwidget.h"
 #include "optionspagecontroller.h"
 #include "src/logic/insulindelivery.h"
+#include "src/logic/deliverythread.h"
 
-QT_CHARTS_USE_NAMESPACE
+class ControlServer;
 
 class HomeScreenWidget : public QWidget {
     Q_OBJECT
@@ -32,6 +36,7 @@ public:
                      IOB* iob,
                      CGMSensor* sensor,
                      QWidget* parent = nullptr);
+    ~HomeScreenWidget();
 public slots:
     void updateStatus();
     void onCreateProfile();
@@ -45,34 +50,56 @@ public slots:
     void updateHistory();
     void updateGraph();
     void onCrashInsulin();
+    // Dialog-free halves of the profile / crash slots; return an error or empty
+    QString createProfile(const QString& name, float basal, float carb, float correction, float target);
+    QString editProfile(float basal, float carb, float correction, float target);
+    QString deleteProfile();
+    void crash();
     void updateOptionsPage();
+    void switchProfile(const QString& name);
+    Profile* currentProfile() const;
 private:
     QLabel* createStatusBox(const QString& title, const QString& value);
+    QWidget* buildHistoryPage();
+    QWidget* buildOptionsPage();
+    void startCgmFeed();
+    QString trendSummary() const;
+    void startControlServer(QPushButton* chargeButton, QPushButton* disconnectButton, QPushButton* occlusionButton);
     QLabel *batteryBox, *insulinBox, *iobBox, *cgmBox;
     QLabel *currentProfileLabel;
-    QTextEdit* m_logTextEdit;
-    QTextEdit* m_historyTextEdit;
-    QChart* m_chart;
-    QScatterSeries* m_graph_points;
-    QScatterSeries* m_predicted_points;
-    QSplineSeries* m_graph_line;
+    EventLogView* m_logView;
+    QListView* m_historyView;
+    HistoryListModel* m_historyModel;
+    QLabel* m_usageLabel;
+    CgmChartWidget* m_cgmChart;
     QLabel* basalStatusLabel;
     QStackedWidget* m_mainStackedWidget;
-    QVBoxLayout* m_profileButtonsLayout;
     DataManager* m_dataManager;
+    std::unique_ptr<TimeSeriesStore> m_trendStore;
     ProfileManager* m_profileManager;
     Battery* m_battery;
     InsulinCartridge* m_cartridge;
     IOB* m_iob;
     CGMSensor* m_sensor;
-    Profile* m_currentProfile;
+    ProfileHandle m_currentProfile;  // resolved through m_profileManager
     QTimer* m_chargingTimer;
     NavigationManager* m_navManager;
     QPushButton* m_basalButton;
-    bool m_alertsEnabled;
     OptionsPageController* m_optionsController;
+    ControlServer* m_controlServer;     // only with PUMP_CONTROL_SOCKET
     InsulinDelivery* m_insulinDelivery;
-    void addLog(const QString &message);
+    DeliveryThread* m_delivery;     // sole writer of the pump models once started
+    int m_logSinkId;
+    // Event log: the text / format is copied into a Logger slot, no Qt strings
+    void addLog(const char* message);
+    void addLogf(const char* format, ...)
+#if defined(__GNUC__)
+        __attribute__((format(printf, 2, 3)))
+#endif
+        ;
+    void addLog(const QString &message);    // callbacks and environment values
+    void deliverLogBatch(const QStringList& lines, const QStringList& stamped,
+                         const QVector<EventCategory>& categories);
 
 };
 
@@ -1,5 +1,6 @@
 #include "mainwindow.h"
 #include "pumpsimulatormainwidget.h"
+#include "src/logic/startupmetrics.h"
 
 MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
     setWindowTitle("t:slim X2 Insulin Pump Simulator");
@@ -7,3 +8,8 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
     setCentralWidget(mainWidget);
     resize(650, 550);
 }
+
+void MainWindow::paintEvent(QPaintEvent* event) {
+    QMainWindow::paintEvent(event);
+    StartupMetrics::instance().finish("first paint");
+}
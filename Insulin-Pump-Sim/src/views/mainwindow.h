@@ -9,6 +9,9 @@
 class MainWindow : public QMainWindow {
 public:
     MainWindow(QWidget* parent = nullptr);
+protected:
+    // First paint closes the startup timing
+    void paintEvent(QPaintEvent* event) override;
 };
 
 #endif // MAINWINDOW_H
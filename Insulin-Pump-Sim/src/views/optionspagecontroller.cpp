@@ -8,6 +8,9 @@
 #include <QPushButton>
 #include <QTimer>
 #include <QMessageBox>
+#include <QLineEdit>
+#include <QListView>
+#include "profilelistmodel.h"
 
 OptionsPageController::OptionsPageController(QWidget* parent, ProfileManager* profileMgr)
     : QObject(parent), m_profileMgr(profileMgr)
@@ -16,11 +19,32 @@ OptionsPageController::OptionsPageController(QWidget* parent, ProfileManager* pr
     m_optionsLayout = new QVBoxLayout(m_optionsPage);
     m_optionsLayout->addWidget(new QLabel("Options Screen", m_optionsPage));
 
-    // Box for profile switching
+    // Box for profile switching -> searchable list over ProfileManager
     QGroupBox* switchProfileGroup = new QGroupBox("Switch Profile", m_optionsPage);
-    m_profileButtonsLayout = new QVBoxLayout();
-    switchProfileGroup->setLayout(m_profileButtonsLayout);
+    QVBoxLayout* switchLayout = new QVBoxLayout();
+    m_profileModel = new ProfileListModel(m_profileMgr, this);
+    m_profileFilter = new ProfileFilterModel(this);
+    m_profileFilter->setSourceModel(m_profileModel);
+    m_profileSearch = new QLineEdit(m_optionsPage);
+    m_profileSearch->setPlaceholderText("Search profiles...");
+    m_profileSearch->setClearButtonEnabled(true);
+    m_profileList = new QListView(m_optionsPage);
+    m_profileList->setModel(m_profileFilter);
+    m_profileList->setUniformItemSizes(true);
+    m_profileList->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_noProfileLabel = new QLabel("No other profiles available", m_optionsPage);
+    switchLayout->addWidget(m_profileSearch);
+    switchLayout->addWidget(m_profileList);
+    switchLayout->addWidget(m_noProfileLabel);
+    switchProfileGroup->setLayout(switchLayout);
     m_optionsLayout->addWidget(switchProfileGroup);
+    connect(m_profileSearch, &QLineEdit::textChanged, m_profileFilter, &QSortFilterProxyModel::setFilterFixedString);
+    connect(m_profileList, &QListView::clicked, this, &OptionsPageController::onProfileActivated);
+    connect(m_profileFilter, &QAbstractItemModel::rowsInserted, this, &OptionsPageController::updateEmptyLabel);
+    connect(m_profileFilter, &QAbstractItemModel::rowsRemoved, this, &OptionsPageController::updateEmptyLabel);
+    connect(m_profileFilter, &QAbstractItemModel::modelReset, this, &OptionsPageController::updateEmptyLabel);
+    connect(m_profileFilter, &QAbstractItemModel::layoutChanged, this, &OptionsPageController::updateEmptyLabel);
+    updateEmptyLabel();
 
     // Alert toggle -> disable alrts when they click on the box
     m_alertToggle = new QCheckBox("Disable Alerts", m_optionsPage);
@@ -72,30 +96,19 @@ QWidget* OptionsPageController::getWidget() const {
     return m_optionsPage;
 }
 
-void OptionsPageController::updateProfileSwitching(const std::vector<Profile>& profiles,
-                                                   Profile* currentProfile,
-                                                   std::function<void(const Profile&)> onProfileSwitch)
-{
-    //Get rid of the buttons for the profile
-    QLayoutItem* child;
-    while ((child = m_profileButtonsLayout->takeAt(0)) != nullptr) {
-        if(child->widget())
-            child->widget()->deleteLater();
-        delete child;
-    }
-    bool anyAdded = false;
-    for(const auto& profile : profiles) {
-        if(currentProfile && profile.getName() == currentProfile->getName())
-            continue;
-        QPushButton* profileButton = new QPushButton(QString::fromStdString(profile.getName()), m_optionsPage);
-        connect(profileButton, &QPushButton::clicked, [onProfileSwitch, profile]() {
-            onProfileSwitch(profile);
-        });
-        m_profileButtonsLayout->addWidget(profileButton);
-        anyAdded = true;
-    }
-    if (!anyAdded) {
-        QLabel* noProfileLabel = new QLabel("No other profiles available", m_optionsPage);
-        m_profileButtonsLayout->addWidget(noProfileLabel);
-    }
+void OptionsPageController::setCurrentProfile(const Profile* currentProfile) {
+    m_profileFilter->setExcludedName(currentProfile ? QString::fromStdString(currentProfile->getName()) : QString());
+    updateEmptyLabel();
+}
+
+void OptionsPageController::updateEmptyLabel() {
+    m_noProfileLabel->setVisible(m_profileFilter->rowCount() == 0);
+}
+
+void OptionsPageController::onProfileActivated(const QModelIndex& index) {
+    if (!index.isValid())
+        return;
+    QString name = index.data().toString();
+    m_profileList->clearSelection();
+    emit profileSwitchRequested(name);
 }
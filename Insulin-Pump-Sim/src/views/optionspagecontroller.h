@@ -2,13 +2,16 @@
 #define OPTIONSPAGECONTROLLER_H
 
 #include <QObject>
-#include <vector>
-#include <functional>
 #include "src/models/profile.h"
 #include "src/models/profilemanager.h"
 
 class QWidget;
 class QVBoxLayout;
+class QLineEdit;
+class QListView;
+class QModelIndex;
+class ProfileListModel;
+class ProfileFilterModel;
 class QCheckBox;
 class QSpinBox;
 class QPushButton;
@@ -21,11 +24,10 @@ public:
     QWidget* getWidget() const;
 
 
-    // Update the profile-switching
-    void updateProfileSwitching(const std::vector<Profile>& profiles,
-                                Profile* currentProfile,
-                                std::function<void(const Profile&)> onProfileSwitch);
+    // Hide the loaded profile from the switch list
+    void setCurrentProfile(const Profile* currentProfile);
 signals:
+    void profileSwitchRequested(const QString& name);
     void alertToggled(bool disabled);
     void changePinRequested();
     void sleepModeToggled(bool enabled, int timeout);
@@ -36,7 +38,11 @@ signals:
 private:
     QWidget* m_optionsPage;
     QVBoxLayout* m_optionsLayout;
-    QVBoxLayout* m_profileButtonsLayout;
+    QLineEdit* m_profileSearch;
+    QListView* m_profileList;
+    QLabel* m_noProfileLabel;
+    ProfileListModel* m_profileModel;
+    ProfileFilterModel* m_profileFilter;
     QCheckBox* m_alertToggle;
     QSpinBox* m_sleepTimeoutBox;
     QCheckBox* m_sleepModeToggle;
@@ -46,6 +52,9 @@ private:
     QPushButton* m_backButton;
 
     ProfileManager* m_profileMgr;
+
+    void updateEmptyLabel();
+    void onProfileActivated(const QModelIndex& index);
 };
 
 #endif // OPTIONSPAGECONTROLLER_H
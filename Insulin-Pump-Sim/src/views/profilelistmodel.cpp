@@ -0,0 +1,80 @@
+#include "profilelistmodel.h"
+
+ProfileListModel::ProfileListModel(ProfileManager* profileMgr, QObject* parent)
+    : QAbstractListModel(parent), m_profileMgr(profileMgr)
+{
+    m_profileMgr->setListener(this);
+}
+
+ProfileListModel::~ProfileListModel() {
+    m_profileMgr->setListener(nullptr);
+}
+
+int ProfileListModel::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid())
+        return 0;
+    return static_cast<int>(m_profileMgr->slotCount());
+}
+
+QVariant ProfileListModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid())
+        return QVariant();
+    const Profile* profile = m_profileMgr->profileAt(index.row());
+    if (role == LiveRole)
+        return profile != nullptr;
+    if (!profile)
+        return QVariant();
+    if (role == Qt::DisplayRole)
+        return QString::fromStdString(profile->getName());
+    if (role == Qt::ToolTipRole)
+        return QString("Basal %1 u/hr | Target %2 mmol/L")
+            .arg(profile->getBasalRate())
+            .arg(profile->getTargetGlucose());
+    return QVariant();
+}
+
+void ProfileListModel::profileAboutToBeAdded(int row) {
+    beginInsertRows(QModelIndex(), row, row);
+}
+
+void ProfileListModel::profileAdded(int) {
+    endInsertRows();
+}
+
+void ProfileListModel::profileChanged(int row) {
+    QModelIndex changed = index(row);
+    emit dataChanged(changed, changed);
+}
+
+void ProfileListModel::profilesAboutToBeReset() {
+    beginResetModel();
+}
+
+void ProfileListModel::profilesReset() {
+    endResetModel();
+}
+
+ProfileFilterModel::ProfileFilterModel(QObject* parent)
+    : QSortFilterProxyModel(parent)
+{
+    setFilterCaseSensitivity(Qt::CaseInsensitive);
+    setSortCaseSensitivity(Qt::CaseInsensitive);
+    setDynamicSortFilter(true);
+    sort(0);
+}
+
+void ProfileFilterModel::setExcludedName(const QString& name) {
+    if (name == m_excludedName)
+        return;
+    m_excludedName = name;
+    invalidateFilter();
+}
+
+bool ProfileFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const {
+    QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
+    if (!index.data(ProfileListModel::LiveRole).toBool())
+        return false;
+    if (!m_excludedName.isEmpty() && index.data().toString() == m_excludedName)
+        return false;
+    return QSortFilterProxyModel::filterAcceptsRow(sourceRow, sourceParent);
+}
@@ -0,0 +1,56 @@
+#ifndef PROFILELISTMODEL_H
+#define PROFILELISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QSortFilterProxyModel>
+#include "src/models/profilemanager.h"
+
+//--------------------------------------------------------
+// PROFILE LIST MODEL
+// List model over ProfileManager's slots. Rows never move:
+// new slots are inserted, and a deleted or reused slot only
+// emits dataChanged. Free slots report LiveRole = false and
+// are hidden by ProfileFilterModel.
+//--------------------------------------------------------
+class ProfileListModel : public QAbstractListModel, public ProfileListener {
+    Q_OBJECT
+public:
+    enum Roles {
+        LiveRole = Qt::UserRole
+    };
+
+    explicit ProfileListModel(ProfileManager* profileMgr, QObject* parent = nullptr);
+    ~ProfileListModel();
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    void profileAboutToBeAdded(int row) override;
+    void profileAdded(int row) override;
+    void profileChanged(int row) override;
+    void profilesAboutToBeReset() override;
+    void profilesReset() override;
+
+private:
+    ProfileManager* m_profileMgr;
+};
+
+//--------------------------------------------------------
+// PROFILE FILTER MODEL
+// Case-insensitive name search, sorted by name, hiding free
+// slots and the profile that is currently loaded.
+//--------------------------------------------------------
+class ProfileFilterModel : public QSortFilterProxyModel {
+    Q_OBJECT
+public:
+    explicit ProfileFilterModel(QObject* parent = nullptr);
+    void setExcludedName(const QString& name);
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+
+private:
+    QString m_excludedName;
+};
+
+#endif // PROFILELISTMODEL_H
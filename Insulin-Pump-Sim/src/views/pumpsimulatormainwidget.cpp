@@ -1,6 +1,11 @@
 #include "pumpsimulatormainwidget.h"
 #include "src/dialogs/pindialog.h"
 #include <QVBoxLayout>
+#include <QDir>
+#include <QStandardPaths>
+#include "src/logic/logger.h"
+#include "src/logic/startupmetrics.h"
+#include <chrono>
 
 PumpSimulatorMainWidget::PumpSimulatorMainWidget(QWidget* parent) : QWidget(parent) {
     m_pump = new InsulinPump();
@@ -10,16 +15,26 @@ PumpSimulatorMainWidget::PumpSimulatorMainWidget(QWidget* parent) : QWidget(pare
     m_sensor = new CGMSensor();
     m_profileManager = new ProfileManager();
 
+    // Profiles persist between runs; every change is saved incrementally
+    QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dataDir);
+    m_profileStore = new ProfileStore(m_profileManager, QDir(dataDir).filePath("profiles.bin").toStdString());
+    if (!m_profileStore->load())
+        Logger::instance().logf(LogChannel::Console, "Profile load failed: %s", m_profileStore->lastError().c_str());
+    m_profileManager->setChangedCallback([this]() {
+        if (!m_profileStore->save())
+            Logger::instance().logf(LogChannel::Console, "Profile save failed: %s", m_profileStore->lastError().c_str());
+    });
+    StartupMetrics::instance().mark("profile load");
+
     // Create the power button and home screen widgets
     m_powerButton = new QPushButton("POWER ON", this);
     m_powerButton->setCheckable(true);
     m_powerButton->setStyleSheet("background-color: lightblue; color: black; font-size: 16px; padding: 10px;");
-    m_homeScreen = new HomeScreenWidget(m_profileManager, m_battery, m_cartridge, m_iob, m_sensor, this);
-    m_homeScreen->setVisible(false);
+    m_homeScreen = nullptr;
 
     QVBoxLayout* layout = new QVBoxLayout(this);
     layout->addWidget(m_powerButton);
-    layout->addWidget(m_homeScreen);
     setLayout(layout);
 
     connect(m_powerButton, &QPushButton::toggled, this, &PumpSimulatorMainWidget::onPowerToggled);
@@ -46,12 +61,13 @@ void PumpSimulatorMainWidget::onPowerToggled(bool checked) {
         }
         m_pump->powerOn();
         m_powerButton->setText("Power Off");
-        m_homeScreen->setVisible(true);
+        homeScreen()->setVisible(true);
         m_homeScreen->updateStatus();  // Update the home screen indicators
     } else {
         m_pump->powerOff();
         m_powerButton->setText("Power On");
-        m_homeScreen->setVisible(false);
+        if (m_homeScreen)
+            m_homeScreen->setVisible(false);
     }
 }
 
@@ -61,7 +77,8 @@ void PumpSimulatorMainWidget::togglePump() {
         m_pump->powerOff();
         m_powerButton->setChecked(false);
         m_powerButton->setText("Power On");
-        m_homeScreen->setVisible(false);
+        if (m_homeScreen)
+            m_homeScreen->setVisible(false);
     } else {
         // Power on the pump: verify PIN if set (or prompt to set)
         if(m_userPIN.isEmpty()) {
@@ -80,11 +97,23 @@ void PumpSimulatorMainWidget::togglePump() {
         m_pump->powerOn();
         m_powerButton->setChecked(true);
         m_powerButton->setText("Power Off");
-        m_homeScreen->setVisible(true);
+        homeScreen()->setVisible(true);
         m_homeScreen->updateStatus();
     }
 }
 
+HomeScreenWidget* PumpSimulatorMainWidget::homeScreen() {
+    if (!m_homeScreen) {
+        auto start = std::chrono::steady_clock::now();
+        m_homeScreen = new HomeScreenWidget(m_profileManager, m_battery, m_cartridge, m_iob, m_sensor, this);
+        m_homeScreen->setVisible(false);
+        layout()->addWidget(m_homeScreen);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        Logger::instance().logf(LogChannel::Console, "[STARTUP] home screen built in %.1f ms", ms);
+    }
+    return m_homeScreen;
+}
+
 // NEW: Setter to update the stored user PIN.
 void PumpSimulatorMainWidget::setUserPIN(const QString &newPIN) {
     m_userPIN = newPIN;
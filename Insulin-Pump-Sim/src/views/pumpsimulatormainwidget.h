@@ -9,6 +9,7 @@
 #include "src/models/iob.h"
 #include "src/models/cgmsensor.h"
 #include "src/models/profilemanager.h"
+#include "src/models/profilestore.h"
 #include "homescreenwidget.h"
 
 //--------------------------------------------------------
@@ -25,12 +26,16 @@ public slots:
     // Update the stored PIN (used when PIN is changed in options).
     void setUserPIN(const QString &newPIN);
 private:
+    // Built on first power-on; nothing behind the PIN is created before that
+    HomeScreenWidget* homeScreen();
+
     InsulinPump* m_pump;
     Battery* m_battery;
     InsulinCartridge* m_cartridge;
     IOB* m_iob;
     CGMSensor* m_sensor;
     ProfileManager* m_profileManager;
+    ProfileStore* m_profileStore;
     QPushButton* m_powerButton;
     HomeScreenWidget* m_homeScreen;
     QString m_userPIN;
@@ -0,0 +1,83 @@
+#include "timingoverlay.h"
+#include "src/logic/handlertiming.h"
+#include "src/logic/logger.h"
+#include <QShortcut>
+#include <algorithm>
+
+namespace {
+constexpr int kProbeMs = 20;
+constexpr int kRefreshMs = 500;
+constexpr std::size_t kShownHandlers = 8;
+}
+
+TimingOverlay::TimingOverlay(QWidget* parent)
+    : QLabel(parent),
+      m_probeTimer(new QTimer(this)),
+      m_refreshTimer(new QTimer(this))
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setStyleSheet("background-color: rgba(0, 0, 0, 170); color: white; font-family: monospace; padding: 4px;");
+    setTextFormat(Qt::PlainText);
+
+    QShortcut* shortcut = new QShortcut(QKeySequence("Ctrl+Shift+T"), parent);
+    connect(shortcut, &QShortcut::activated, this, &TimingOverlay::toggle);
+
+    // Lag = how late the probe fires past its interval
+    m_probeTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_probeTimer, &QTimer::timeout, this, &TimingOverlay::probe);
+    m_sinceProbe.start();
+    m_probeTimer->start(kProbeMs);
+
+    connect(m_refreshTimer, &QTimer::timeout, this, &TimingOverlay::refresh);
+    m_refreshTimer->start(kRefreshMs);
+
+    setVisible(qEnvironmentVariableIsSet("PUMP_TIMING_OVERLAY"));
+    refresh();
+}
+
+void TimingOverlay::toggle() {
+    setVisible(!isVisible());
+    if (isVisible()) {
+        refresh();
+        raise();
+    }
+}
+
+void TimingOverlay::probe() {
+    qint64 elapsed = m_sinceProbe.nsecsElapsed();
+    m_sinceProbe.restart();
+    qint64 late = elapsed - qint64(kProbeMs) * 1000000;
+    HandlerTiming::instance().recordEventLoopLag(late > 0 ? static_cast<std::uint64_t>(late) : 0);
+}
+
+void TimingOverlay::refresh() {
+    if (!isVisible())
+        return;
+    std::vector<HandlerSummary> handlers = HandlerTiming::instance().summaries();
+    std::sort(handlers.begin(), handlers.end(), [](const HandlerSummary& a, const HandlerSummary& b) {
+        return a.p99Ms > b.p99Ms;
+    });
+    if (handlers.size() > kShownHandlers)
+        handlers.resize(kShownHandlers);
+
+    HandlerSummary lag = HandlerTiming::instance().eventLoopLag();
+    QString text = QString("event loop lag  p50 %1  p99 %2  max %3 ms\n")
+                       .arg(lag.p50Ms, 0, 'f', 2).arg(lag.p99Ms, 0, 'f', 2).arg(lag.maxMs, 0, 'f', 2);
+    text += QString("logger  dropped %1  backpressure %2\n")
+                .arg(Logger::instance().droppedCount())
+                .arg(Logger::instance().backpressureCount());
+    for (const HandlerSummary& handler : handlers) {
+        text += QString("%1  n=%2  p50 %3  p99 %4  max %5 ms\n")
+                    .arg(QString::fromStdString(handler.name), -36)
+                    .arg(handler.count)
+                    .arg(handler.p50Ms, 0, 'f', 2).arg(handler.p99Ms, 0, 'f', 2).arg(handler.maxMs, 0, 'f', 2);
+    }
+    setText(text.trimmed());
+    place();
+}
+
+void TimingOverlay::place() {
+    adjustSize();
+    if (QWidget* parent = parentWidget())
+        move(parent->width() - width() - 8, 8);
+}
@@ -0,0 +1,33 @@
+#ifndef TIMINGOVERLAY_H
+#define TIMINGOVERLAY_H
+
+#include <QElapsedTimer>
+#include <QLabel>
+#include <QTimer>
+
+//--------------------------------------------------------
+// TIMING OVERLAY (instrumented builds only)
+// Corner readout of the slowest handlers by p99, the
+// event-loop lag measured by a 20 ms probe timer and the
+// Logger's drop / backpressure counters. Toggled
+// with Ctrl+Shift+T; starts visible when the environment
+// variable PUMP_TIMING_OVERLAY is set.
+//--------------------------------------------------------
+class TimingOverlay : public QLabel {
+    Q_OBJECT
+public:
+    explicit TimingOverlay(QWidget* parent);
+
+    void toggle();
+
+private:
+    void probe();
+    void refresh();
+    void place();
+
+    QTimer* m_probeTimer;
+    QTimer* m_refreshTimer;
+    QElapsedTimer m_sinceProbe;
+};
+
+#endif // TIMINGOVERLAY_H